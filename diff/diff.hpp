@@ -1,2 +1,7 @@
 
+#include "diff/histogram_diff.hpp"
+#include "diff/linear_diff.hpp"
+#include "diff/merge.hpp"
 #include "diff/msg.hpp"
+#include "diff/patch.hpp"
+#include "diff/patience_diff.hpp"
@@ -9,13 +9,25 @@
 #ifndef PKG_DIFF_FORMAT_HPP
 #define PKG_DIFF_FORMAT_HPP
 
+#include <deque>
+#include <functional>
 #include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "diff/myers_diff.hpp"
 
 namespace diff
 {
 
+/// Number of lines to display before lines where differences occured
+const uint8_t lines_before = 3;
+
+/// Number of lines to display after lines where differences occured
+const uint8_t lines_after = 3;
+
 /// Symbol for added lines
 const char add_token = '+';
 
@@ -42,6 +54,348 @@ void diff_line_format (std::ostream& out, T val,
 	out << "\t" << val << "\n";
 }
 
+/// Markers around characters removed from a refined line
+const std::string_view del_open = "[-";
+
+const std::string_view del_close = "-]";
+
+/// Markers around characters added to a refined line
+const std::string_view add_open = "{+";
+
+const std::string_view add_close = "+}";
+
+/// Return true and set orig_line and updated_line to orig and updated
+/// with characters removed from orig and added to updated wrapped in
+/// markers if they differ by at most max_edits characters,
+/// otherwise return false
+inline bool refine_line_pair (std::string& orig_line, std::string& updated_line,
+	std::string_view orig, std::string_view updated, size_t max_edits)
+{
+	if (EXCEEDED_BUDGET == myers_diff_within(orig, updated, max_edits).bound_)
+	{
+		return false;
+	}
+	orig_line.clear();
+	updated_line.clear();
+	bool in_del = false;
+	bool in_add = false;
+	for (const Diff<char>& d : myers_diff(orig, updated))
+	{
+		switch (d.action_)
+		{
+			case EQ:
+				// removals and additions only close at equal characters,
+				// since each only marks one of the lines
+				if (in_del)
+				{
+					orig_line += del_close;
+					in_del = false;
+				}
+				if (in_add)
+				{
+					updated_line += add_close;
+					in_add = false;
+				}
+				orig_line += d.val_;
+				updated_line += d.val_;
+				break;
+			case DEL:
+				if (false == in_del)
+				{
+					orig_line += del_open;
+					in_del = true;
+				}
+				orig_line += d.val_;
+				break;
+			case ADD:
+				if (false == in_add)
+				{
+					updated_line += add_open;
+					in_add = true;
+				}
+				updated_line += d.val_;
+				break;
+		}
+	}
+	if (in_del)
+	{
+		orig_line += del_close;
+	}
+	if (in_add)
+	{
+		updated_line += add_close;
+	}
+	return true;
+}
+
+/// Callback receiving each formatted diff line (including its newline)
+using LineSinkT = std::function<void(const std::string&)>;
+
+/// Streaming formatter that writes differences and their surrounding
+/// context lines as soon as they are known, optionally grouping them into
+/// hunks preceded by "@@ -a,b +c,d @@" headers
+/// Only the context lines that may precede the next difference are held,
+/// so without headers memory does not grow with the number of diffs,
+/// and with headers it grows only with the size of the current hunk
+/// Lines are held by address, so written values must outlive the writer
+/// (e.g.: elements of the diffed sequences)
+/// Call finish once all diffs are written
+template <typename T>
+struct DiffWriter final
+{
+	DiffWriter (std::ostream& out, bool hunk_headers = false,
+		size_t nbefore = lines_before, size_t nafter = lines_after) :
+		out_(&out), hunk_headers_(hunk_headers),
+		nbefore_(nbefore), nafter_(nafter) {}
+
+	DiffWriter (LineSinkT sink, bool hunk_headers = false,
+		size_t nbefore = lines_before, size_t nafter = lines_after) :
+		out_(&buffer_), sink_(sink), hunk_headers_(hunk_headers),
+		nbefore_(nbefore), nafter_(nafter) {}
+
+	DiffWriter (const DiffWriter<T>& other) = delete;
+
+	DiffWriter (DiffWriter<T>&& other) = delete;
+
+	DiffWriter<T>& operator = (const DiffWriter<T>& other) = delete;
+
+	DiffWriter<T>& operator = (DiffWriter<T>&& other) = delete;
+
+	/// Write the next difference
+	void write (const T& val, Action action)
+	{
+		Line line{&val, action, orig_, updated_};
+		switch (action)
+		{
+			case EQ:
+				++orig_;
+				++updated_;
+				break;
+			case ADD:
+				++updated_;
+				break;
+			case DEL:
+				++orig_;
+				break;
+		}
+
+		if (action == EQ)
+		{
+			if (in_hunk_ && ntrailing_ > 0)
+			{
+				--ntrailing_;
+				hunk_line(line);
+				return;
+			}
+			context_.push_back(line);
+			if (context_.size() > nbefore_)
+			{
+				// dropped line is not shown, so it separates hunks
+				context_.pop_front();
+				if (in_hunk_)
+				{
+					flush_hunk();
+				}
+			}
+			return;
+		}
+
+		for (const Line& ctx : context_)
+		{
+			hunk_line(ctx);
+		}
+		context_.clear();
+		hunk_line(line);
+		in_hunk_ = true;
+		ntrailing_ = nafter_;
+	}
+
+	/// Write every difference in diffs of orig and updated (e.g.: from
+	/// myers_diff), holding their elements rather than the values of diffs,
+	/// so diffs need not outlive the writer
+	/// ARR must be random access
+	template <typename INDEX, typename ARR>
+	void write (const std::vector<Diff<T,INDEX>>& diffs,
+		const ARR& orig, const ARR& updated)
+	{
+		for (const Diff<T,INDEX>& d : diffs)
+		{
+			write(d.action_ == ADD ? updated[d.updated_] : orig[d.orig_],
+				d.action_);
+		}
+	}
+
+	/// Highlight characters that changed between the i-th removed and
+	/// i-th added line of each run of differences, if the pair differs
+	/// by at most max_edits characters (see refine_line_pair)
+	/// Only lines that are written are refined
+	void refine_lines (size_t max_edits)
+	{
+		static_assert(std::is_convertible<const T&,std::string_view>::value,
+			"only string lines can be refined");
+		refine_ = true;
+		refine_edits_ = max_edits;
+	}
+
+	/// Write the last hunk if any
+	void finish (void)
+	{
+		if (in_hunk_)
+		{
+			flush_hunk();
+		}
+		context_.clear();
+	}
+
+private:
+	struct Line final
+	{
+		const T* val_;
+
+		Action action_;
+
+		int64_t orig_;
+
+		int64_t updated_;
+	};
+
+	void hunk_line (const Line& line)
+	{
+		if (hunk_headers_ || (refine_ && line.action_ != EQ))
+		{
+			pending_.push_back(line);
+			return;
+		}
+		write_pending();
+		write_line(line, *line.val_);
+	}
+
+	void flush_hunk (void)
+	{
+		in_hunk_ = false;
+		if (hunk_headers_ && pending_.size() > 0)
+		{
+			int64_t norig = 0;
+			int64_t nupdated = 0;
+			for (const Line& line : pending_)
+			{
+				norig += line.action_ != ADD;
+				nupdated += line.action_ != DEL;
+			}
+			// empty ranges start at the line before them as in unified diffs
+			const Line& first = pending_.front();
+			*out_ << "@@ -" << first.orig_ + (norig > 0) << "," << norig <<
+				" +" << first.updated_ + (nupdated > 0) << "," << nupdated <<
+				" @@\n";
+			emit();
+		}
+		write_pending();
+	}
+
+	void write_pending (void)
+	{
+		for (size_t i = 0, n = pending_.size(); i < n;)
+		{
+			if (false == refine_ || pending_[i].action_ == EQ)
+			{
+				write_line(pending_[i], *pending_[i].val_);
+				++i;
+				continue;
+			}
+			size_t end = i;
+			for (; end < n && pending_[end].action_ != EQ; ++end);
+			write_refined_run(i, end);
+			i = end;
+		}
+		pending_.clear();
+	}
+
+	/// Write pending lines in [begin, end), all of which are differences,
+	/// pairing the i-th removed line with the i-th added line
+	void write_refined_run (size_t begin, size_t end)
+	{
+		if constexpr (std::is_convertible<const T&,std::string_view>::value)
+		{
+			std::vector<size_t> dels;
+			std::vector<size_t> adds;
+			for (size_t i = begin; i < end; ++i)
+			{
+				(pending_[i].action_ == DEL ? dels : adds).push_back(i);
+			}
+			std::vector<std::string> texts(end - begin);
+			std::vector<bool> refined(end - begin, false);
+			for (size_t i = 0, n = std::min(dels.size(), adds.size());
+				i < n; ++i)
+			{
+				size_t del = dels[i] - begin;
+				size_t add = adds[i] - begin;
+				refined[del] = refined[add] = refine_line_pair(
+					texts[del], texts[add],
+					*pending_[dels[i]].val_, *pending_[adds[i]].val_,
+					refine_edits_);
+			}
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (refined[i - begin])
+				{
+					write_line(pending_[i], texts[i - begin]);
+				}
+				else
+				{
+					write_line(pending_[i], *pending_[i].val_);
+				}
+			}
+		}
+	}
+
+	template <typename V>
+	void write_line (const Line& line, const V& val)
+	{
+		diff_line_format(*out_, val, line.action_, line.orig_, line.updated_);
+		emit();
+	}
+
+	void emit (void)
+	{
+		if (sink_)
+		{
+			sink_(buffer_.str());
+			buffer_.str("");
+		}
+	}
+
+	std::ostringstream buffer_;
+
+	std::ostream* out_;
+
+	LineSinkT sink_;
+
+	bool hunk_headers_;
+
+	size_t nbefore_;
+
+	size_t nafter_;
+
+	/// Equal lines after the last difference that are not yet shown
+	std::deque<Line> context_;
+
+	/// Lines of the current hunk when writing hunk headers,
+	/// otherwise differences since the last equal line when refining
+	std::vector<Line> pending_;
+
+	bool refine_ = false;
+
+	size_t refine_edits_ = 0;
+
+	bool in_hunk_ = false;
+
+	size_t ntrailing_ = 0;
+
+	int64_t orig_ = 0;
+
+	int64_t updated_ = 0;
+};
+
 }
 
 #endif // PKG_DIFF_FORMAT_HPP
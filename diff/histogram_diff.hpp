@@ -0,0 +1,188 @@
+///
+/// histogram_diff.hpp
+/// diff
+///
+/// Purpose:
+/// Define and implement histogram diff algorithm
+///
+/// the longest common region seeded by the rarest element of the orig range is
+/// aligned, then regions before and after are diffed the same way, falling
+/// back to myers_diff if a region has no element rare enough to seed from
+///
+
+#ifndef PKG_DIFF_HISTOGRAM_HPP
+#define PKG_DIFF_HISTOGRAM_HPP
+
+#include "diff/patience_diff.hpp"
+
+namespace diff
+{
+
+/// Elements occurring more than this many times in a region are not seeds
+const size_t histogram_max_chain = 64;
+
+/// Histogram differ that writes diffs of orig and updated range into diffs
+/// ITER must be random access
+template <typename ITER, typename COMPARATOR, typename HASHER,
+	typename INDEX=IndexT>
+struct HistogramDiffer final
+{
+	using ValT = typename std::iterator_traits<ITER>::value_type;
+
+	/// Map each element to its ascending positions in an orig range
+	using HistogramT = std::unordered_map<const ValT*,std::vector<INDEX>,
+		ElemRefHash<ValT,HASHER>,ElemRefEqual<ValT,COMPARATOR>>;
+
+	HistogramDiffer (ITER orig_begin, ITER updated_begin) :
+		orig_begin_(orig_begin), updated_begin_(updated_begin) {}
+
+	/// Append the diffs of orig[obegin:oend] and updated[ubegin:uend]
+	void diff (std::vector<Diff<ValT,INDEX>>& diffs,
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend)
+	{
+		// common prefix and suffix are aligned before searching for anchors
+		COMPARATOR comparator;
+		INDEX nprefix = snake_length(comparator,
+			orig_begin_ + obegin, updated_begin_ + ubegin,
+			std::min(oend - obegin, uend - ubegin));
+		for (INDEX i = 0; i < nprefix; ++i, ++obegin, ++ubegin)
+		{
+			diffs.push_back(Diff<ValT,INDEX>{
+				orig_begin_[obegin], obegin, ubegin, EQ});
+		}
+		INDEX nsuffix = reverse_snake_length(comparator,
+			orig_begin_ + oend, updated_begin_ + uend,
+			std::min(oend - obegin, uend - ubegin));
+		oend -= nsuffix;
+		uend -= nsuffix;
+
+		// regions after each match are diffed iteratively to bound recursion,
+		// sharing the histogram of the range since only obegin advances
+		HistogramT histogram = make_histogram(obegin, oend);
+		while (obegin < oend || ubegin < uend)
+		{
+			INDEX region_obegin, region_ubegin, nregion;
+			if (false == rarest_region(region_obegin, region_ubegin, nregion,
+				histogram, obegin, oend, ubegin, uend))
+			{
+				myers_range_diff<COMPARATOR,INDEX>(workspace_, diffs,
+					orig_begin_, obegin, oend, updated_begin_, ubegin, uend);
+				break;
+			}
+			diff(diffs, obegin, region_obegin, ubegin, region_ubegin);
+			for (INDEX i = 0; i < nregion; ++i)
+			{
+				diffs.push_back(Diff<ValT,INDEX>{
+					orig_begin_[region_obegin + i],
+					static_cast<INDEX>(region_obegin + i),
+					static_cast<INDEX>(region_ubegin + i), EQ});
+			}
+			obegin = region_obegin + nregion;
+			ubegin = region_ubegin + nregion;
+		}
+
+		for (INDEX i = 0; i < nsuffix; ++i, ++oend, ++uend)
+		{
+			diffs.push_back(Diff<ValT,INDEX>{
+				orig_begin_[oend], oend, uend, EQ});
+		}
+	}
+
+	/// Return the histogram of orig[obegin:oend]
+	HistogramT make_histogram (INDEX obegin, INDEX oend) const
+	{
+		HistogramT histogram;
+		histogram.reserve(oend - obegin);
+		for (INDEX i = obegin; i < oend; ++i)
+		{
+			histogram[&orig_begin_[i]].push_back(i);
+		}
+		return histogram;
+	}
+
+	/// Return true and set the common region of length nregion starting at
+	/// out_obegin and out_ubegin that is seeded by the element of
+	/// orig[obegin:oend] with the fewest occurrences, preferring longer
+	/// regions among equally rare seeds, otherwise return false
+	/// histogram must cover orig[hbegin:oend] for some hbegin <= obegin
+	bool rarest_region (INDEX& out_obegin, INDEX& out_ubegin, INDEX& nregion,
+		const HistogramT& histogram,
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend) const
+	{
+		COMPARATOR comparator;
+		size_t best_count = histogram_max_chain;
+		nregion = 0;
+		for (INDEX j = ubegin; j < uend;)
+		{
+			auto it = histogram.find(&updated_begin_[j]);
+			if (histogram.end() == it)
+			{
+				++j;
+				continue;
+			}
+			// skip positions before obegin that earlier regions consumed
+			auto first = std::lower_bound(
+				it->second.begin(), it->second.end(), obegin);
+			size_t count = it->second.end() - first;
+			if (0 == count || count > best_count)
+			{
+				++j;
+				continue;
+			}
+			INDEX next_j = j + 1;
+			for (auto pos = first, last = it->second.end(); pos != last; ++pos)
+			{
+				INDEX i = *pos;
+				INDEX nbefore = reverse_snake_length(comparator,
+					orig_begin_ + i, updated_begin_ + j,
+					std::min(i - obegin, j - ubegin));
+				INDEX nafter = snake_length(comparator,
+					orig_begin_ + i, updated_begin_ + j,
+					std::min(oend - i, uend - j));
+				INDEX length = nbefore + nafter;
+				if (count < best_count || length > nregion)
+				{
+					best_count = count;
+					out_obegin = i - nbefore;
+					out_ubegin = j - nbefore;
+					nregion = length;
+				}
+				next_j = std::max(next_j, j + nafter);
+			}
+			j = next_j;
+		}
+		return nregion > 0;
+	}
+
+private:
+	ITER orig_begin_;
+
+	ITER updated_begin_;
+
+	/// Buffers shared by the myers searches of every region
+	DiffWorkspace<INDEX> workspace_;
+};
+
+/// Return list of differences between orig and updated arrays aligned
+/// on common regions containing the rarest elements first
+/// Result is not necessarily minimum-cost, but like patience_diff it avoids
+/// aligning on frequently repeated elements, and handles arrays without
+/// unique elements better than patience_diff
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT, typename HASHER=std::hash<ArrValT<ARR>>>
+std::vector<DiffArrT<ARR,INDEX>> histogram_diff (
+	const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	std::vector<DiffArrT<ARR,INDEX>> diffs;
+	HistogramDiffer<typename IndexedArr<ARR>::IterT,
+		COMPARATOR,HASHER,INDEX> differ(
+		orig_view.begin(), updated_view.begin());
+	differ.diff(diffs, 0, orig_view.size(), 0, updated_view.size());
+	return diffs;
+}
+
+}
+
+#endif // PKG_DIFF_HISTOGRAM_HPP
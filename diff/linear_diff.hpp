@@ -0,0 +1,285 @@
+///
+/// linear_diff.hpp
+/// diff
+///
+/// Purpose:
+/// Define and implement linear space variant of myers diff algorithm
+///
+/// implementation bisects the edit graph at the middle snake as described in
+/// section 4b of "An O(ND) Difference Algorithm and Its Variations" (Myers 1986)
+///
+
+#ifndef PKG_DIFF_LINEAR_HPP
+#define PKG_DIFF_LINEAR_HPP
+
+#include <algorithm>
+#include <limits>
+
+#include "diff/myers_diff.hpp"
+
+namespace diff
+{
+
+/// Middle snake of an edit graph bisection
+/// from (x_, y_) to (u_, v_) with the cost of the entire D-path
+template <typename INDEX=IndexT>
+struct MiddleSnake
+{
+	INDEX x_;
+
+	INDEX y_;
+
+	INDEX u_;
+
+	INDEX v_;
+
+	INDEX cost_;
+};
+
+/// Return true if LinearDiffer indexes the frontiers of arrays of n and m
+/// elements with INDEX, whose diagonals span n + m + 4 entries
+template <typename INDEX=IndexT>
+constexpr bool linear_diff_fits (size_t n, size_t m)
+{
+	size_t max_size = std::numeric_limits<INDEX>::max();
+	return n <= max_size && m <= max_size - n && n + m <= max_size - 4;
+}
+
+/// Linear space differ that writes diffs of orig and updated range into diffs
+/// ITER must be random access, and n and m must fit (see linear_diff_fits)
+/// Forward and reverse frontiers are shared across recursions to keep
+/// memory usage at O(orig.size + updated.size)
+template <typename ITER, typename COMPARATOR, typename INDEX=IndexT>
+struct LinearDiffer final
+{
+	using ValT = typename std::iterator_traits<ITER>::value_type;
+
+	LinearDiffer (ITER orig_begin, INDEX n,
+		ITER updated_begin, INDEX m) :
+		orig_begin_(orig_begin), updated_begin_(updated_begin),
+		offset_((n + m + 1) / 2 + 1),
+		forward_(2 * offset_ + 1, 0), reverse_(2 * offset_ + 1, 0) {}
+
+	/// Append the diffs of orig[obegin:oend] and updated[ubegin:uend]
+	void diff (std::vector<Diff<ValT,INDEX>>& diffs,
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend)
+	{
+		// common prefix and suffix never need to enter the search
+		while (obegin < oend && ubegin < uend &&
+			equal(obegin, ubegin))
+		{
+			diffs.push_back(Diff<ValT,INDEX>{orig(obegin), obegin, ubegin, EQ});
+			++obegin;
+			++ubegin;
+		}
+		INDEX nsuffix = 0;
+		while (obegin < oend && ubegin < uend &&
+			equal(oend - 1, uend - 1))
+		{
+			--oend;
+			--uend;
+			++nsuffix;
+		}
+
+		if (obegin == oend)
+		{
+			for (INDEX i = ubegin; i < uend; ++i)
+			{
+				diffs.push_back(Diff<ValT,INDEX>{updated(i), -1, i, ADD});
+			}
+		}
+		else if (ubegin == uend)
+		{
+			for (INDEX i = obegin; i < oend; ++i)
+			{
+				diffs.push_back(Diff<ValT,INDEX>{orig(i), i, -1, DEL});
+			}
+		}
+		else
+		{
+			// after trimming, the first and last elements differ,
+			// so cost is at least 2 and both halves cost strictly less
+			MiddleSnake<INDEX> snake = middle_snake(obegin, oend, ubegin, uend);
+			diff(diffs, obegin, obegin + snake.x_, ubegin, ubegin + snake.y_);
+			for (INDEX i = snake.x_, j = snake.y_; i < snake.u_; ++i, ++j)
+			{
+				diffs.push_back(Diff<ValT,INDEX>{orig(obegin + i),
+					static_cast<INDEX>(obegin + i),
+					static_cast<INDEX>(ubegin + j), EQ});
+			}
+			diff(diffs, obegin + snake.u_, oend, ubegin + snake.v_, uend);
+		}
+
+		for (INDEX i = 0; i < nsuffix; ++i, ++oend, ++uend)
+		{
+			diffs.push_back(Diff<ValT,INDEX>{orig(oend), oend, uend, EQ});
+		}
+	}
+
+	/// Return the middle snake of orig[obegin:oend] and updated[ubegin:uend]
+	/// Snake coordinates are relative to obegin and ubegin
+	MiddleSnake<INDEX> middle_snake (
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend)
+	{
+		INDEX n = oend - obegin;
+		INDEX m = uend - ubegin;
+		INDEX delta = n - m;
+		bool odd = (delta % 2) != 0;
+		INDEX max_edit = (n + m + 1) / 2;
+
+		forward_[offset_ + 1] = 0;
+		reverse_[offset_ + 1] = 0;
+		for (INDEX iedit = 0; iedit <= max_edit; ++iedit)
+		{
+			// forward search from (0, 0)
+			for (INDEX k = -iedit; k <= iedit; k += 2)
+			{
+				INDEX x;
+				if (k == -iedit || (k != iedit &&
+					forward_[offset_ + k - 1] < forward_[offset_ + k + 1]))
+				{
+					x = forward_[offset_ + k + 1];
+				}
+				else
+				{
+					x = forward_[offset_ + k - 1] + 1;
+				}
+				INDEX y = x - k;
+				INDEX startx = x;
+				INDEX starty = y;
+				if (x < n && y < m)
+				{
+					INDEX snake = snake_length(comparator_,
+						orig_begin_ + obegin + x, updated_begin_ + ubegin + y,
+						std::min(n - x, m - y));
+					x += snake;
+					y += snake;
+				}
+				forward_[offset_ + k] = x;
+
+				// forward diagonal k overlaps reverse diagonal delta - k
+				INDEX rk = delta - k;
+				if (odd && rk >= -(iedit - 1) && rk <= iedit - 1 &&
+					x + reverse_[offset_ + rk] >= n)
+				{
+					return MiddleSnake<INDEX>{startx, starty, x, y,
+						static_cast<INDEX>(2 * iedit - 1)};
+				}
+			}
+
+			// reverse search from (n, m) where x counts from the end
+			for (INDEX k = -iedit; k <= iedit; k += 2)
+			{
+				INDEX x;
+				if (k == -iedit || (k != iedit &&
+					reverse_[offset_ + k - 1] < reverse_[offset_ + k + 1]))
+				{
+					x = reverse_[offset_ + k + 1];
+				}
+				else
+				{
+					x = reverse_[offset_ + k - 1] + 1;
+				}
+				INDEX y = x - k;
+				INDEX startx = x;
+				INDEX starty = y;
+				if (x < n && y < m)
+				{
+					INDEX snake = reverse_snake_length(comparator_,
+						orig_begin_ + oend - x, updated_begin_ + uend - y,
+						std::min(n - x, m - y));
+					x += snake;
+					y += snake;
+				}
+				reverse_[offset_ + k] = x;
+
+				INDEX fk = delta - k;
+				if (false == odd && fk >= -iedit && fk <= iedit &&
+					x + forward_[offset_ + fk] >= n)
+				{
+					return MiddleSnake<INDEX>{
+						static_cast<INDEX>(n - x),
+						static_cast<INDEX>(m - y),
+						static_cast<INDEX>(n - startx),
+						static_cast<INDEX>(m - starty),
+						static_cast<INDEX>(2 * iedit)};
+				}
+			}
+		}
+		assert(false); // paths must overlap by max_edit
+		return MiddleSnake<INDEX>{0, 0, 0, 0, 0};
+	}
+
+private:
+	bool equal (INDEX i, INDEX j) const
+	{
+		return comparator_(orig(i), updated(j));
+	}
+
+	const ValT& orig (INDEX i) const
+	{
+		return orig_begin_[i];
+	}
+
+	const ValT& updated (INDEX i) const
+	{
+		return updated_begin_[i];
+	}
+
+	COMPARATOR comparator_;
+
+	ITER orig_begin_;
+
+	ITER updated_begin_;
+
+	/// Index of diagonal 0 in forward_ and reverse_
+	INDEX offset_;
+
+	/// Furthest x reached per diagonal searching from the start
+	std::vector<INDEX> forward_;
+
+	/// Furthest distance from the end reached per diagonal
+	/// searching from the end
+	std::vector<INDEX> reverse_;
+};
+
+/// Return minimum-cost list of differences between orig and updated arrays
+/// using O(orig.size + updated.size) memory
+/// Output has the same format and cost as myers_diff, but when multiple
+/// minimum-cost edit scripts exist, the chosen script can differ from
+/// myers_diff's, since bisecting at the middle snake breaks ties
+/// differently than backtracing the greedy forward search
+/// (e.g.: "BCCBCCB" to "CBACBACBACB")
+/// Callers check linear_diff_fits for inputs that may not fit INDEX
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+std::vector<DiffArrT<ARR,INDEX>> linear_myers_diff (
+	const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	assert(linear_diff_fits<INDEX>(orig_view.size(), updated_view.size()));
+	INDEX n = orig_view.size();
+	INDEX m = updated_view.size();
+
+	std::vector<DiffArrT<ARR,INDEX>> diffs;
+	diffs.reserve(n + m);
+	LinearDiffer<typename IndexedArr<ARR>::IterT,COMPARATOR,INDEX> differ(
+		orig_view.begin(), n, updated_view.begin(), m);
+	differ.diff(diffs, 0, n, 0, m);
+
+	// order deletions before additions in each edit run like myers_diff
+	for (auto it = diffs.begin(), et = diffs.end(); it != et;)
+	{
+		auto run_end = std::find_if(it, et,
+			[](const DiffArrT<ARR,INDEX>& d) { return d.action_ == EQ; });
+		std::stable_partition(it, run_end,
+			[](const DiffArrT<ARR,INDEX>& d) { return d.action_ == DEL; });
+		it = run_end == et ? et : std::next(run_end);
+	}
+	return diffs;
+}
+
+}
+
+#endif // PKG_DIFF_LINEAR_HPP
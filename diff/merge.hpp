@@ -0,0 +1,141 @@
+///
+/// merge.hpp
+/// diff
+///
+/// Purpose:
+/// Define and implement three-way merge (diff3) of arrays
+///
+/// base is diffed against ours and theirs, then both edit scripts are walked
+/// together, splitting the arrays into stable chunks (unchanged by either)
+/// and unstable chunks, each taken from whichever side changed it,
+/// or marked as conflict if both sides changed it differently
+///
+
+#ifndef PKG_DIFF_MERGE_HPP
+#define PKG_DIFF_MERGE_HPP
+
+#include "diff/myers_diff.hpp"
+
+namespace diff
+{
+
+/// Encoding of how a merge chunk is resolved
+enum MergeAction
+{
+	/// Base, ours, and theirs are the same
+	STABLE = 0,
+	/// Only ours changed base, or both changed it the same way
+	TAKE_OURS,
+	/// Only theirs changed base
+	TAKE_THEIRS,
+	/// Ours and theirs changed base differently
+	CONFLICT,
+};
+
+/// Chunk of a three-way merge, where each range is [first, second)
+template <typename INDEX=IndexT>
+struct MergeChunk final
+{
+	MergeAction action_;
+
+	PointT<INDEX> base_;
+
+	PointT<INDEX> ours_;
+
+	PointT<INDEX> theirs_;
+};
+
+/// Return chunks covering base, ours, and theirs arrays in order,
+/// where ours and theirs are changes to base
+/// Each array is visited a constant number of times after the two
+/// myers_diff searches, so merging is linear in the size of the arrays
+/// and their edit scripts
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+std::vector<MergeChunk<INDEX>> diff3 (
+	const ARR& base, const ARR& ours, const ARR& theirs)
+{
+	IndexedArr<ARR> base_view(base);
+	IndexedArr<ARR> ours_view(ours);
+	IndexedArr<ARR> theirs_view(theirs);
+	INDEX nbase = base_view.size();
+	INDEX nours = ours_view.size();
+	INDEX ntheirs = theirs_view.size();
+
+	// position each base element is kept at in ours and theirs, or -1
+	DiffWorkspace<INDEX> workspace;
+	std::vector<DiffArrT<ARR,INDEX>> diffs;
+	auto kept = [&](std::vector<INDEX>& positions, const ARR& updated)
+	{
+		myers_diff<ARR,COMPARATOR,INDEX>(workspace, diffs, base, updated);
+		positions.assign(nbase, -1);
+		for (const DiffArrT<ARR,INDEX>& d : diffs)
+		{
+			if (d.action_ == EQ)
+			{
+				positions[d.orig_] = d.updated_;
+			}
+		}
+	};
+	std::vector<INDEX> in_ours;
+	std::vector<INDEX> in_theirs;
+	kept(in_ours, ours);
+	kept(in_theirs, theirs);
+
+	COMPARATOR comparator;
+	auto same_range = [&comparator](auto lhs, INDEX lbegin, INDEX lend,
+		auto rhs, INDEX rbegin, INDEX rend)
+	{
+		return lend - lbegin == rend - rbegin && lend - lbegin ==
+			snake_length(comparator, lhs + lbegin, rhs + rbegin, lend - lbegin);
+	};
+
+	std::vector<MergeChunk<INDEX>> chunks;
+	INDEX i = 0;
+	INDEX j = 0;
+	INDEX k = 0;
+	while (i < nbase || j < nours || k < ntheirs)
+	{
+		INDEX ibegin = i;
+		INDEX jbegin = j;
+		INDEX kbegin = k;
+		for (; i < nbase && in_ours[i] == j && in_theirs[i] == k;
+			++i, ++j, ++k);
+		if (i > ibegin)
+		{
+			chunks.push_back(MergeChunk<INDEX>{STABLE,
+				{ibegin, i}, {jbegin, j}, {kbegin, k}});
+			continue;
+		}
+
+		// unstable chunk ends at the next base element kept by both
+		INDEX iend = i;
+		for (; iend < nbase && (in_ours[iend] < 0 || in_theirs[iend] < 0);
+			++iend);
+		INDEX jend = iend < nbase ? in_ours[iend] : nours;
+		INDEX kend = iend < nbase ? in_theirs[iend] : ntheirs;
+
+		MergeAction action = CONFLICT;
+		if (same_range(base_view.begin(), i, iend, ours_view.begin(), j, jend))
+		{
+			action = TAKE_THEIRS;
+		}
+		else if (same_range(base_view.begin(), i, iend,
+			theirs_view.begin(), k, kend) ||
+			same_range(ours_view.begin(), j, jend,
+			theirs_view.begin(), k, kend))
+		{
+			action = TAKE_OURS;
+		}
+		chunks.push_back(MergeChunk<INDEX>{action,
+			{i, iend}, {j, jend}, {k, kend}});
+		i = iend;
+		j = jend;
+		k = kend;
+	}
+	return chunks;
+}
+
+}
+
+#endif // PKG_DIFF_MERGE_HPP
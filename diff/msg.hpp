@@ -9,40 +9,131 @@
 #ifndef PKG_DIFF_MSG_HPP
 #define PKG_DIFF_MSG_HPP
 
-#include <cstring>
+#include <limits>
 #include <istream>
+#include <thread>
 
 #include "fmts/fmts.hpp"
 
 #include "diff/format.hpp"
+#include "diff/histogram_diff.hpp"
+#include "diff/merge.hpp"
+#include "diff/patience_diff.hpp"
 
 namespace diff
 {
 
-/// Number of lines to display before lines where differences occured
-const uint8_t lines_before = 3;
-
-/// Number of lines to display after lines where differences occured
-const uint8_t lines_after = 3;
+/// Encoding of algorithms used to diff messages
+enum Algorithm
+{
+	/// Minimum-cost diff (myers_diff)
+	MYERS = 0,
+	/// Diff aligned on unique lines (patience_diff)
+	PATIENCE,
+	/// Diff aligned on least frequent lines (histogram_diff)
+	HISTOGRAM,
+};
 
 /// Return diff message of multiple lines
 /// Message is empty if the lines are the same
+/// If refine_edits is positive, characters that changed between paired
+/// removed and added lines differing by at most refine_edits characters
+/// are highlighted (see refine_line_pair)
 /// Caveat: the product of size of the vectors is roughly limited to 2^32,
 /// this function does not perform any optimization to diff long messages
 std::string diff_msg (
 	const types::StringsT& expected,
-	const types::StringsT& got);
+	const types::StringsT& got,
+	Algorithm algo = MYERS,
+	size_t refine_edits = 0);
 
-/// Same as diff_msg, except it diffs the message in batches
+/// Same as diff_msg, except it diffs the message in batches of batch_limit
+/// By default, inputs are only batched once they overflow the diff IndexT
 std::string safe_diff_msg (
 	const types::StringsT& expected,
 	const types::StringsT& got,
-	size_t batch_limit = std::numeric_limits<IndexT>::max());
+	size_t batch_limit = std::numeric_limits<IndexT>::max(),
+	Algorithm algo = MYERS);
+
+/// Same as diff_msg, except both inputs are first split into regions at
+/// lines occurring exactly once in each of them, and regions are diffed
+/// concurrently by up to nthreads threads
+/// Result is not necessarily minimum-cost, since like patience_diff
+/// unique lines are aligned first
+std::string parallel_diff_msg (
+	const types::StringsT& expected,
+	const types::StringsT& got,
+	size_t nthreads = std::thread::hardware_concurrency(),
+	Algorithm algo = MYERS);
+
+/// Same as safe_diff_msg, except differences are streamed to out
+/// as they are computed, grouped into hunks with "@@ -a,b +c,d @@" headers
+void write_diff_msg (std::ostream& out,
+	const types::StringsT& expected,
+	const types::StringsT& got,
+	size_t batch_limit = std::numeric_limits<IndexT>::max(),
+	Algorithm algo = MYERS,
+	size_t refine_edits = 0);
+
+/// Same as write_diff_msg, except each formatted line is passed to sink
+void write_diff_msg (const LineSinkT& sink,
+	const types::StringsT& expected,
+	const types::StringsT& got,
+	size_t batch_limit = std::numeric_limits<IndexT>::max(),
+	Algorithm algo = MYERS,
+	size_t refine_edits = 0);
 
 std::string diff_lines (
 	std::istream& expect, std::istream& got,
 	bool ignore_empty_lines = true,
-	bool trim_spaces = true);
+	bool trim_spaces = true,
+	Algorithm algo = MYERS);
+
+/// Options for diffing lines of files
+struct DiffOptions final
+{
+	/// Skip empty lines (after trimming if trim_spaces_)
+	bool ignore_empty_lines_ = true;
+
+	/// Ignore leading and trailing white-spaces of each line
+	bool trim_spaces_ = true;
+
+	Algorithm algo_ = MYERS;
+
+	/// Highlight changed characters of paired lines differing by at most
+	/// this many characters, 0 disables highlighting
+	size_t refine_edits_ = 0;
+};
+
+/// Return diff message of lines in the files at path_a and path_b
+/// Files are memory-mapped and lines are views into the mappings,
+/// so lines are neither copied nor individually allocated
+/// Throw std::runtime_error if either file cannot be mapped
+std::string diff_files (
+	const std::string& path_a, const std::string& path_b,
+	const DiffOptions& opts = DiffOptions());
+
+/// Marker starting lines from ours in a merge conflict
+const std::string_view ours_marker = "<<<<<<< ours";
+
+/// Marker starting lines from base in a merge conflict
+const std::string_view base_marker = "||||||| base";
+
+/// Marker starting lines from theirs in a merge conflict
+const std::string_view separator_marker = "=======";
+
+/// Marker ending a merge conflict
+const std::string_view theirs_marker = ">>>>>>> theirs";
+
+/// Set merged to lines of base with changes from both ours and theirs
+/// and return the number of conflicts, where ours and theirs changed the
+/// same lines differently
+/// Each conflict is written as lines from ours, base, and theirs separated
+/// by ours_marker, base_marker, separator_marker, and theirs_marker
+size_t merge_lines (types::StringsT& merged,
+	const types::StringsT& base,
+	const types::StringsT& ours,
+	const types::StringsT& theirs);
 
 }
 
@@ -12,44 +12,228 @@
 #ifndef PKG_DIFF_MYERS_HPP
 #define PKG_DIFF_MYERS_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <utility>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
+#include "diff/snake.hpp"
+
 namespace diff
 {
 
-using IndexT = int16_t;
+/// Default index type of diff positions
+/// Combined size of diffed inputs must not exceed the index type's maximum
+using IndexT = int32_t;
 
-using PointT = std::pair<IndexT,IndexT>;
+template <typename INDEX=IndexT>
+using PointT = std::pair<INDEX,INDEX>;
 
 template <typename ARR>
 using ArrValT = typename std::iterator_traits<
 	typename ARR::iterator>::value_type;
 
-/// Return the minimum number of edits between orig and updated arrays
-template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>>
-size_t myers_diff_min_edit (const ARR& orig, const ARR& updated)
+template <typename ARR>
+using ArrIterCatT = typename std::iterator_traits<
+	typename ARR::const_iterator>::iterator_category;
+
+/// True if ARR stores its elements contiguously (e.g.: vector, string)
+template <typename ARR, typename=void>
+struct is_contiguous final : std::false_type {};
+
+template <typename ARR>
+struct is_contiguous<ARR,std::void_t<decltype(
+	std::data(std::declval<const ARR&>()))>> final : std::is_same<
+		const ArrValT<ARR>*,
+		decltype(std::data(std::declval<const ARR&>()))> {};
+
+/// True if ARR iterators are random access (e.g.: deque)
+template <typename ARR>
+using is_random_access = std::is_base_of<
+	std::random_access_iterator_tag,ArrIterCatT<ARR>>;
+
+/// Constant-time indexable view of array elements used by the diff searches
+/// Non-random-access arrays (e.g.: list) are copied into a buffer once
+template <typename ARR, typename=void>
+struct IndexedArr final
+{
+	using IterT = typename std::vector<ArrValT<ARR>>::const_iterator;
+
+	IndexedArr (const ARR& arr) : buffer_(std::begin(arr), std::end(arr)) {}
+
+	IterT begin (void) const
+	{
+		return buffer_.cbegin();
+	}
+
+	size_t size (void) const
+	{
+		return buffer_.size();
+	}
+
+private:
+	std::vector<ArrValT<ARR>> buffer_;
+};
+
+/// Indexed view of contiguous arrays as raw pointers
+template <typename ARR>
+struct IndexedArr<ARR,typename std::enable_if<
+	is_contiguous<ARR>::value>::type> final
+{
+	using IterT = const ArrValT<ARR>*;
+
+	IndexedArr (const ARR& arr) :
+		begin_(std::data(arr)), size_(std::size(arr)) {}
+
+	IterT begin (void) const
+	{
+		return begin_;
+	}
+
+	size_t size (void) const
+	{
+		return size_;
+	}
+
+private:
+	IterT begin_;
+
+	size_t size_;
+};
+
+/// Indexed view of non-contiguous random access arrays as their iterators
+template <typename ARR>
+struct IndexedArr<ARR,typename std::enable_if<
+	!is_contiguous<ARR>::value && is_random_access<ARR>::value>::type> final
+{
+	using IterT = typename ARR::const_iterator;
+
+	IndexedArr (const ARR& arr) :
+		begin_(std::begin(arr)), size_(std::size(arr)) {}
+
+	IterT begin (void) const
+	{
+		return begin_;
+	}
+
+	size_t size (void) const
+	{
+		return size_;
+	}
+
+private:
+	IterT begin_;
+
+	size_t size_;
+};
+
+/// Return the lengths of the common prefix (first) and common suffix (second)
+/// of orig and updated arrays where the suffix never overlaps the prefix
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+PointT<INDEX> myers_diff_affixes (const ARR& orig, const ARR& updated)
 {
 	COMPARATOR comparator;
-	auto orig_begin = std::begin(orig);
-	auto updated_begin = std::begin(updated);
-	IndexT n = std::distance(orig_begin, std::end(orig));
-	IndexT m = std::distance(updated_begin, std::end(updated));
-	IndexT max_edit = n + m;
-
-	IndexT x, y;
-	size_t ncost = 2 * max_edit + 1;
-	std::vector<IndexT> costs(ncost, 0);
-	bool cont = true;
-	IndexT min_edits = max_edit;
-	for (IndexT iedit = 0; iedit < max_edit && cont; ++iedit)
+	auto orig_it = std::begin(orig);
+	auto updated_it = std::begin(updated);
+	auto orig_end = std::end(orig);
+	auto updated_end = std::end(updated);
+	INDEX nprefix = 0;
+	for (; orig_it != orig_end && updated_it != updated_end &&
+		comparator(*orig_it, *updated_it); ++orig_it, ++updated_it)
+	{
+		++nprefix;
+	}
+	INDEX nsuffix = 0;
+	for (; orig_it != orig_end && updated_it != updated_end &&
+		comparator(*std::prev(orig_end), *std::prev(updated_end));
+		--orig_end, --updated_end)
+	{
+		++nsuffix;
+	}
+	return {nprefix, nsuffix};
+}
+
+/// Buffers reused across myers searches, so repeated searches of
+/// similar sizes stop allocating once the buffers have grown
+template <typename INDEX=IndexT>
+struct DiffWorkspace final
+{
+	/// Furthest reaching x of each diagonal for the current edit count
+	std::vector<INDEX> costs_;
+
+	/// Rows of costs_ for every edit count (see myers_diff_trace)
+	std::vector<INDEX> trace_;
+
+	/// Points of the last backtrace (see myers_diff_backtrace)
+	std::vector<PointT<INDEX>> points_;
+};
+
+/// Outcome of comparing the edit distance of two arrays against a budget
+enum EditBound
+{
+	/// Arrays are identical
+	IDENTICAL = 0,
+	/// Arrays differ by no more than the budget
+	WITHIN_BUDGET,
+	/// Arrays differ by more than the budget
+	EXCEEDED_BUDGET,
+};
+
+/// Result of myers_diff_within
+struct BoundedEdit final
+{
+	EditBound bound_;
+
+	/// Minimum number of edits if bound_ is not EXCEEDED_BUDGET
+	/// otherwise a lower bound greater than the budget
+	size_t nedits_;
+};
+
+/// Return whether orig and updated arrays differ by at most max_edits,
+/// and the minimum number of edits if they do
+/// The search stops once every D-path of max_edits edits is explored,
+/// so the cost is O((N+M)*max_edits) time and O(max_edits) space
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+BoundedEdit myers_diff_within (DiffWorkspace<INDEX>& workspace,
+	const ARR& orig, const ARR& updated, size_t max_edits)
+{
+	COMPARATOR comparator;
+	// common prefix and suffix cost nothing, so search only between them
+	auto affixes = myers_diff_affixes<ARR,COMPARATOR,INDEX>(orig, updated);
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	auto orig_begin = orig_view.begin() + affixes.first;
+	auto updated_begin = updated_view.begin() + affixes.first;
+	INDEX n = orig_view.size() - affixes.first - affixes.second;
+	INDEX m = updated_view.size() - affixes.first - affixes.second;
+	if (n == 0 && m == 0)
+	{
+		return BoundedEdit{IDENTICAL, 0};
+	}
+
+	// at least |n - m| insertions or deletions are needed
+	size_t min_bound = n > m ? n - m : m - n;
+	if (min_bound > max_edits)
+	{
+		return BoundedEdit{EXCEEDED_BUDGET, min_bound};
+	}
+	INDEX max_edit = std::min(static_cast<size_t>(n + m), max_edits);
+
+	INDEX x, y;
+	size_t ncost = 2 * static_cast<size_t>(max_edit) + 1;
+	std::vector<INDEX>& costs = workspace.costs_;
+	costs.assign(ncost, 0);
+	for (INDEX iedit = 0; iedit <= max_edit; ++iedit)
 	{
-		for (IndexT k = -iedit; k <= iedit && cont; k += 2)
+		for (INDEX k = -iedit; k <= iedit; k += 2)
 		{
-			IndexT prevk = costs[(ncost + k - 1) % ncost];
-			IndexT nextk = costs[(ncost + k + 1) % ncost];
+			INDEX prevk = costs[(ncost + k - 1) % ncost];
+			INDEX nextk = costs[(ncost + k + 1) % ncost];
 			if (k == -iedit || (k != iedit && prevk < nextk))
 			{
 				x = nextk;
@@ -61,53 +245,70 @@ size_t myers_diff_min_edit (const ARR& orig, const ARR& updated)
 
 			y = x - k;
 
-			while (x < n && y < m && comparator(
-				*std::next(orig_begin, x), *std::next(updated_begin, y)))
+			if (x < n && y < m)
 			{
-				++x;
-				++y;
+				INDEX snake = snake_length(comparator,
+					orig_begin + x, updated_begin + y, std::min(n - x, m - y));
+				x += snake;
+				y += snake;
 			}
 
 			costs[(ncost + k) % ncost] = x;
 
 			if (x >= n && y >= m)
 			{
-				min_edits = iedit;
-				cont = false;
+				return BoundedEdit{WITHIN_BUDGET, static_cast<size_t>(iedit)};
 			}
 		}
 	}
-	return min_edits;
+	return BoundedEdit{EXCEEDED_BUDGET, static_cast<size_t>(max_edit) + 1};
 }
 
-/// Return the diff trace, the flattened representation of 2-D array
-/// <2 * (orig.size + updated.size) + 1, min_edits>
-/// each row in the trace matrix are the minimum costs at every step
-/// each row's origin starts at index orig.size + updated.size
-/// zeros in each row represent unreachable states at that step
-/// This function is a helper function for myers_diff, but can use in diagnosis
-template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>>
-std::vector<IndexT> myers_diff_trace (ARR orig, ARR updated)
+/// Same as myers_diff_within using a temporary workspace
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+BoundedEdit myers_diff_within (const ARR& orig, const ARR& updated,
+	size_t max_edits)
+{
+	DiffWorkspace<INDEX> workspace;
+	return myers_diff_within<ARR,COMPARATOR,INDEX>(
+		workspace, orig, updated, max_edits);
+}
+
+/// Return the minimum number of edits between orig and updated arrays
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+size_t myers_diff_min_edit (const ARR& orig, const ARR& updated)
+{
+	// n + m edits always suffice, so the budget is never exceeded
+	return myers_diff_within<ARR,COMPARATOR,INDEX>(orig, updated,
+		std::size(orig) + std::size(updated)).nedits_;
+}
+
+/// Set workspace trace to the diff trace of n elements from orig_begin and
+/// m elements from updated_begin (see myers_diff_trace)
+/// Iterators must be random access
+template <typename COMPARATOR, typename INDEX, typename ITER>
+void myers_range_trace (DiffWorkspace<INDEX>& workspace,
+	ITER orig_begin, INDEX n, ITER updated_begin, INDEX m)
 {
 	COMPARATOR comparator;
-	auto orig_begin = std::begin(orig);
-	auto updated_begin = std::begin(updated);
-	IndexT n = std::distance(orig_begin, std::end(orig));
-	IndexT m = std::distance(updated_begin, std::end(updated));
-	IndexT max_edit = n + m;
-
-	IndexT x, y;
-	size_t ncost = 2 * max_edit + 1;
-	std::vector<IndexT> costs(ncost, 0);
-	std::vector<IndexT> trace;
+	INDEX max_edit = n + m;
+
+	INDEX x, y;
+	size_t ncost = 2 * static_cast<size_t>(max_edit) + 1;
+	std::vector<INDEX>& costs = workspace.costs_;
+	std::vector<INDEX>& trace = workspace.trace_;
+	costs.assign(ncost, 0);
+	trace.clear();
 	bool cont = true;
-	for (IndexT iedit = 0; iedit <= max_edit && cont; ++iedit)
+	for (INDEX iedit = 0; iedit <= max_edit && cont; ++iedit)
 	{
 		trace.insert(trace.end(), costs.begin(), costs.end());
-		for (IndexT k = -iedit; k <= iedit && cont; k += 2)
+		for (INDEX k = -iedit; k <= iedit && cont; k += 2)
 		{
-			IndexT prevk = costs[(ncost + k - 1) % ncost];
-			IndexT nextk = costs[(ncost + k + 1) % ncost];
+			INDEX prevk = costs[(ncost + k - 1) % ncost];
+			INDEX nextk = costs[(ncost + k + 1) % ncost];
 			if (k == -iedit || (k != iedit && prevk < nextk))
 			{
 				x = nextk;
@@ -119,41 +320,46 @@ std::vector<IndexT> myers_diff_trace (ARR orig, ARR updated)
 
 			y = x - k;
 
-			while (x < n && y < m && comparator(
-				*std::next(orig_begin, x), *std::next(updated_begin, y)))
+			if (x < n && y < m)
 			{
-				++x;
-				++y;
+				INDEX snake = snake_length(comparator,
+					orig_begin + x, updated_begin + y, std::min(n - x, m - y));
+				x += snake;
+				y += snake;
 			}
 
 			costs[(ncost + k) % ncost] = x;
 			cont = x < n || y < m;
 		}
 	}
-	return trace;
 }
 
-/// Returns a vector of points (X being orig index and Y being updated index)
-/// These points represent the minimum cost diffs
-/// This function is a helper function for myers_diff, but can use in diagnosis
-template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>>
-std::vector<PointT> myers_diff_backtrace (ARR orig, ARR updated)
+/// Set workspace points to the backtrace of n elements from orig_begin and
+/// m elements from updated_begin (see myers_diff_backtrace)
+/// Iterators must be random access
+template <typename COMPARATOR, typename INDEX, typename ITER>
+void myers_range_backtrace (DiffWorkspace<INDEX>& workspace,
+	ITER orig_begin, INDEX n, ITER updated_begin, INDEX m)
 {
-	IndexT x = std::distance(std::begin(orig), std::end(orig));
-	IndexT y = std::distance(std::begin(updated), std::end(updated));
-	IndexT ncost = 2 * (x + y) + 1;
-	IndexT prev_x, prev_y, prev_k;
-
-	auto traces = myers_diff_trace<ARR,COMPARATOR>(orig, updated);
-
-	std::vector<PointT> points;
-	IndexT ntraces = traces.size() / ncost;
-	for (IndexT iedit = ntraces - 1; iedit >= 0; --iedit)
+	INDEX x = n;
+	INDEX y = m;
+	size_t ncost = 2 * static_cast<size_t>(x + y) + 1;
+	INDEX prev_x, prev_y, prev_k;
+
+	myers_range_trace<COMPARATOR,INDEX>(
+		workspace, orig_begin, n, updated_begin, m);
+	const std::vector<INDEX>& traces = workspace.trace_;
+
+	std::vector<PointT<INDEX>>& points = workspace.points_;
+	points.clear();
+	INDEX ntraces = traces.size() / ncost;
+	for (INDEX iedit = ntraces - 1; iedit >= 0; --iedit)
 	{
-		IndexT k = x - y;
+		INDEX k = x - y;
+		size_t row = iedit * ncost;
 		if (k == -iedit || (k != iedit &&
-			traces[iedit * ncost + (ncost + k - 1) % ncost] <
-			traces[iedit * ncost + (ncost + k + 1) % ncost]))
+			traces[row + (ncost + k - 1) % ncost] <
+			traces[row + (ncost + k + 1) % ncost]))
 		{
 			prev_k = k + 1;
 		}
@@ -162,7 +368,7 @@ std::vector<PointT> myers_diff_backtrace (ARR orig, ARR updated)
 			prev_k = k - 1;
 		}
 
-		prev_x = traces[iedit * ncost + (ncost + prev_k) % ncost];
+		prev_x = traces[row + (ncost + prev_k) % ncost];
 		prev_y = prev_x - prev_k;
 
 		while (x > prev_x && y > prev_y)
@@ -178,7 +384,64 @@ std::vector<PointT> myers_diff_backtrace (ARR orig, ARR updated)
 		x = prev_x;
 		y = prev_y;
 	}
-	return points;
+}
+
+/// Return the diff trace, the flattened representation of 2-D array
+/// <2 * (orig.size + updated.size) + 1, min_edits>
+/// each row in the trace matrix are the minimum costs at every step
+/// each row's origin starts at index orig.size + updated.size
+/// zeros in each row represent unreachable states at that step
+/// This function is a helper function for myers_diff, but can use in diagnosis
+/// Returned trace is owned by workspace and valid until its next use
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+const std::vector<INDEX>& myers_diff_trace (DiffWorkspace<INDEX>& workspace,
+	const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	myers_range_trace<COMPARATOR,INDEX>(workspace,
+		orig_view.begin(), static_cast<INDEX>(orig_view.size()),
+		updated_view.begin(), static_cast<INDEX>(updated_view.size()));
+	return workspace.trace_;
+}
+
+/// Same as myers_diff_trace using a temporary workspace
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+std::vector<INDEX> myers_diff_trace (const ARR& orig, const ARR& updated)
+{
+	DiffWorkspace<INDEX> workspace;
+	myers_diff_trace<ARR,COMPARATOR,INDEX>(workspace, orig, updated);
+	return std::move(workspace.trace_);
+}
+
+/// Returns a vector of points (X being orig index and Y being updated index)
+/// These points represent the minimum cost diffs
+/// This function is a helper function for myers_diff, but can use in diagnosis
+/// Returned points are owned by workspace and valid until its next use
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+const std::vector<PointT<INDEX>>& myers_diff_backtrace (
+	DiffWorkspace<INDEX>& workspace, const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	myers_range_backtrace<COMPARATOR,INDEX>(workspace,
+		orig_view.begin(), static_cast<INDEX>(orig_view.size()),
+		updated_view.begin(), static_cast<INDEX>(updated_view.size()));
+	return workspace.points_;
+}
+
+/// Same as myers_diff_backtrace using a temporary workspace
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+std::vector<PointT<INDEX>> myers_diff_backtrace (
+	const ARR& orig, const ARR& updated)
+{
+	DiffWorkspace<INDEX> workspace;
+	myers_diff_backtrace<ARR,COMPARATOR,INDEX>(workspace, orig, updated);
+	return std::move(workspace.points_);
 }
 
 /// Encode of edit action
@@ -189,65 +452,143 @@ enum Action {
 };
 
 /// Diff representation
-template <typename T>
+template <typename T, typename INDEX=IndexT>
 struct Diff
 {
 	/// Character being edited
 	T val_;
 
 	/// Character position in the original array (-1 if not found in original)
-	IndexT orig_;
+	INDEX orig_;
 
 	/// Character position in the updated array (-1 if not found in original)
-	IndexT updated_;
+	INDEX updated_;
 
 	/// Edit action
 	Action action_;
 };
 
-template <typename ARR>
-using DiffArrT = Diff<ArrValT<ARR>>;
-
-/// Return minimum-cost list of differences between orig and updated arrays
-template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>>
-std::vector<DiffArrT<ARR>> myers_diff (ARR orig, ARR updated)
+template <typename ARR, typename INDEX=IndexT>
+using DiffArrT = Diff<ArrValT<ARR>,INDEX>;
+
+/// Append minimum-cost differences between orig_begin[obegin:oend] and
+/// updated_begin[ubegin:uend] to diffs with positions relative to
+/// orig_begin and updated_begin
+/// Common prefix and suffix are reported as EQ without entering the search
+/// Iterators must be random access
+template <typename COMPARATOR, typename INDEX, typename ITER, typename T>
+void myers_range_diff (DiffWorkspace<INDEX>& workspace,
+	std::vector<Diff<T,INDEX>>& diffs,
+	ITER orig_begin, INDEX obegin, INDEX oend,
+	ITER updated_begin, INDEX ubegin, INDEX uend)
 {
-	std::vector<DiffArrT<ARR>> diffs;
-	PointT prev{orig.size(), updated.size()};
-	auto points = myers_diff_backtrace<ARR,COMPARATOR>(orig, updated);
-	for (PointT& next : points)
+	COMPARATOR comparator;
+	INDEX nprefix = snake_length(comparator,
+		orig_begin + obegin, updated_begin + ubegin,
+		std::min(oend - obegin, uend - ubegin));
+	INDEX nsuffix = reverse_snake_length(comparator,
+		orig_begin + oend, updated_begin + uend,
+		std::min(oend - obegin, uend - ubegin) - nprefix);
+
+	for (INDEX i = 0; i < nprefix; ++i)
 	{
-		if (next.first == prev.first)
-		{
-			diffs.push_back(DiffArrT<ARR>{
-				updated[next.second],
-				-1,
-				next.second,
-				ADD
-			});
-		}
-		else if (next.second == prev.second)
-		{
-			diffs.push_back(DiffArrT<ARR>{
-				orig[next.first],
-				next.first,
-				-1,
-				DEL
-			});
-		}
-		else
+		diffs.push_back(Diff<T,INDEX>{orig_begin[obegin + i],
+			static_cast<INDEX>(obegin + i),
+			static_cast<INDEX>(ubegin + i), EQ});
+	}
+	INDEX core_obegin = obegin + nprefix;
+	INDEX core_ubegin = ubegin + nprefix;
+	INDEX core_oend = oend - nsuffix;
+	INDEX core_uend = uend - nsuffix;
+	if (core_obegin < core_oend || core_ubegin < core_uend)
+	{
+		size_t nprev = diffs.size();
+		PointT<INDEX> prev(core_oend, core_uend);
+		myers_range_backtrace<COMPARATOR,INDEX>(workspace,
+			orig_begin + core_obegin, core_oend - core_obegin,
+			updated_begin + core_ubegin, core_uend - core_ubegin);
+		for (PointT<INDEX> next : workspace.points_)
 		{
-			diffs.push_back(DiffArrT<ARR>{
-				orig[next.first],
-				next.first,
-				next.second,
-				EQ,
-			});
+			next.first += core_obegin;
+			next.second += core_ubegin;
+			if (next.first == prev.first)
+			{
+				diffs.push_back(Diff<T,INDEX>{
+					updated_begin[next.second],
+					-1,
+					next.second,
+					ADD
+				});
+			}
+			else if (next.second == prev.second)
+			{
+				diffs.push_back(Diff<T,INDEX>{
+					orig_begin[next.first],
+					next.first,
+					-1,
+					DEL
+				});
+			}
+			else
+			{
+				diffs.push_back(Diff<T,INDEX>{
+					orig_begin[next.first],
+					next.first,
+					next.second,
+					EQ,
+				});
+			}
+			prev = next;
 		}
-		prev = next;
+		// backtrace visits the core from its end
+		std::reverse(diffs.begin() + nprev, diffs.end());
+	}
+	for (INDEX i = core_oend, j = core_uend; i < oend; ++i, ++j)
+	{
+		diffs.push_back(Diff<T,INDEX>{orig_begin[i], i, j, EQ});
 	}
-	return std::vector<DiffArrT<ARR>>(
-		diffs.rbegin(), diffs.rend());
+}
+
+/// Same as myers_range_diff using a temporary workspace
+template <typename COMPARATOR, typename INDEX, typename ITER, typename T>
+void myers_range_diff (std::vector<Diff<T,INDEX>>& diffs,
+	ITER orig_begin, INDEX obegin, INDEX oend,
+	ITER updated_begin, INDEX ubegin, INDEX uend)
+{
+	DiffWorkspace<INDEX> workspace;
+	myers_range_diff<COMPARATOR,INDEX>(workspace, diffs,
+		orig_begin, obegin, oend, updated_begin, ubegin, uend);
+}
+
+/// Set diffs to the minimum-cost list of differences between
+/// orig and updated arrays, reusing the buffers of workspace and diffs
+/// Once buffers have grown, contiguous or random access arrays are diffed
+/// without allocating
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+void myers_diff (DiffWorkspace<INDEX>& workspace,
+	std::vector<DiffArrT<ARR,INDEX>>& diffs,
+	const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	diffs.clear();
+	myers_range_diff<COMPARATOR,INDEX>(workspace, diffs,
+		orig_view.begin(), INDEX(0), static_cast<INDEX>(orig_view.size()),
+		updated_view.begin(), INDEX(0), static_cast<INDEX>(updated_view.size()));
+}
+
+/// Return minimum-cost list of differences between orig and updated arrays
+/// Common prefix and suffix are reported as EQ without entering the search
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT>
+std::vector<DiffArrT<ARR,INDEX>> myers_diff (
+	const ARR& orig, const ARR& updated)
+{
+	DiffWorkspace<INDEX> workspace;
+	std::vector<DiffArrT<ARR,INDEX>> diffs;
+	myers_diff<ARR,COMPARATOR,INDEX>(workspace, diffs, orig, updated);
+	return diffs;
 }
 
 }
@@ -0,0 +1,60 @@
+///
+/// patch.hpp
+/// diff
+///
+/// Purpose:
+/// Define binary patches that transform one byte array into another
+///
+/// a patch is a varint-encoded header <orig size, updated size> followed by
+/// operations, each starting with varint (length << 1 | kind) where
+/// COPY_OP is followed by the zigzag varint distance from the end of the
+/// previous copy to the copied orig offset,
+/// and INSERT_OP is followed by the length bytes to insert
+///
+
+#ifndef PKG_DIFF_PATCH_HPP
+#define PKG_DIFF_PATCH_HPP
+
+#include <string>
+#include <string_view>
+
+#include "diff/myers_diff.hpp"
+
+namespace diff
+{
+
+/// Encoding of patch operations
+enum PatchOp
+{
+	/// Copy a range of orig
+	COPY_OP = 0,
+	/// Insert bytes stored in the patch
+	INSERT_OP,
+};
+
+/// Append unsigned LEB128 encoding of value to out
+void write_varint (std::string& out, uint64_t value);
+
+/// Set value to the unsigned LEB128 value starting at in[pos] and
+/// advance pos past it, return false if in ends before the value does
+bool read_varint (uint64_t& value, std::string_view in, size_t& pos);
+
+/// Return patch that transforms the norig bytes diffed by diffs into
+/// the nupdated bytes, where diffs is a script from any of the diff
+/// functions (e.g.: myers_diff) of the bytes
+std::string encode_patch (const std::vector<Diff<char>>& diffs,
+	size_t norig, size_t nupdated);
+
+/// Return patch that transforms orig into updated
+/// Bytes are diffed with linear_myers_diff, so memory used by the search
+/// is linear in the size of the inputs
+/// Caveat: orig and updated are limited to the maximum of IndexT bytes
+std::string make_patch (std::string_view orig, std::string_view updated);
+
+/// Return orig transformed by patch
+/// Throw std::runtime_error if patch is malformed or not made for orig
+std::string apply_patch (std::string_view orig, std::string_view patch);
+
+}
+
+#endif // PKG_DIFF_PATCH_HPP
@@ -0,0 +1,215 @@
+///
+/// patience_diff.hpp
+/// diff
+///
+/// Purpose:
+/// Define and implement patience diff algorithm
+///
+/// elements occurring exactly once in both arrays are aligned by their
+/// longest increasing subsequence, then regions between these anchors are
+/// diffed recursively, falling back to myers_diff if a region has no anchors
+///
+
+#ifndef PKG_DIFF_PATIENCE_HPP
+#define PKG_DIFF_PATIENCE_HPP
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "diff/myers_diff.hpp"
+
+namespace diff
+{
+
+/// Hash element referenced by pointer using HASHER on the element value
+template <typename T, typename HASHER>
+struct ElemRefHash final
+{
+	size_t operator() (const T* elem) const
+	{
+		return hasher_(*elem);
+	}
+
+	HASHER hasher_;
+};
+
+/// Compare elements referenced by pointer using COMPARATOR on element values
+template <typename T, typename COMPARATOR>
+struct ElemRefEqual final
+{
+	bool operator() (const T* lhs, const T* rhs) const
+	{
+		return comparator_(*lhs, *rhs);
+	}
+
+	COMPARATOR comparator_;
+};
+
+/// Patience differ that writes diffs of orig and updated range into diffs
+/// ITER must be random access
+template <typename ITER, typename COMPARATOR, typename HASHER,
+	typename INDEX=IndexT>
+struct PatienceDiffer final
+{
+	using ValT = typename std::iterator_traits<ITER>::value_type;
+
+	PatienceDiffer (ITER orig_begin, ITER updated_begin) :
+		orig_begin_(orig_begin), updated_begin_(updated_begin) {}
+
+	/// Append the diffs of orig[obegin:oend] and updated[ubegin:uend]
+	void diff (std::vector<Diff<ValT,INDEX>>& diffs,
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend)
+	{
+		// common prefix and suffix are aligned before searching for anchors
+		COMPARATOR comparator;
+		INDEX nprefix = snake_length(comparator,
+			orig_begin_ + obegin, updated_begin_ + ubegin,
+			std::min(oend - obegin, uend - ubegin));
+		for (INDEX i = 0; i < nprefix; ++i, ++obegin, ++ubegin)
+		{
+			diffs.push_back(Diff<ValT,INDEX>{
+				orig_begin_[obegin], obegin, ubegin, EQ});
+		}
+		INDEX nsuffix = reverse_snake_length(comparator,
+			orig_begin_ + oend, updated_begin_ + uend,
+			std::min(oend - obegin, uend - ubegin));
+		oend -= nsuffix;
+		uend -= nsuffix;
+
+		auto anchors = unique_anchors(obegin, oend, ubegin, uend);
+		if (anchors.empty())
+		{
+			myers_range_diff<COMPARATOR,INDEX>(workspace_, diffs,
+				orig_begin_, obegin, oend, updated_begin_, ubegin, uend);
+		}
+		else
+		{
+			for (PointT<INDEX>& anchor : anchors)
+			{
+				diff(diffs, obegin, anchor.first, ubegin, anchor.second);
+				diffs.push_back(Diff<ValT,INDEX>{orig_begin_[anchor.first],
+					anchor.first, anchor.second, EQ});
+				obegin = anchor.first + 1;
+				ubegin = anchor.second + 1;
+			}
+			diff(diffs, obegin, oend, ubegin, uend);
+		}
+
+		for (INDEX i = 0; i < nsuffix; ++i, ++oend, ++uend)
+		{
+			diffs.push_back(Diff<ValT,INDEX>{
+				orig_begin_[oend], oend, uend, EQ});
+		}
+	}
+
+	/// Return the longest increasing sequence of (orig, updated) positions
+	/// of elements occurring exactly once in each of
+	/// orig[obegin:oend] and updated[ubegin:uend]
+	std::vector<PointT<INDEX>> unique_anchors (
+		INDEX obegin, INDEX oend, INDEX ubegin, INDEX uend) const
+	{
+		struct Occurrence
+		{
+			INDEX norig_ = 0;
+
+			INDEX nupdated_ = 0;
+
+			INDEX orig_ = 0;
+
+			INDEX updated_ = 0;
+		};
+		std::unordered_map<const ValT*,Occurrence,
+			ElemRefHash<ValT,HASHER>,ElemRefEqual<ValT,COMPARATOR>> occurrences;
+		occurrences.reserve(oend - obegin);
+		for (INDEX i = obegin; i < oend; ++i)
+		{
+			Occurrence& occ = occurrences[&orig_begin_[i]];
+			++occ.norig_;
+			occ.orig_ = i;
+		}
+		for (INDEX i = ubegin; i < uend; ++i)
+		{
+			auto it = occurrences.find(&updated_begin_[i]);
+			if (occurrences.end() != it)
+			{
+				++it->second.nupdated_;
+				it->second.updated_ = i;
+			}
+		}
+
+		// candidates ordered by orig position
+		std::vector<PointT<INDEX>> candidates;
+		for (INDEX i = obegin; i < oend; ++i)
+		{
+			const Occurrence& occ = occurrences[&orig_begin_[i]];
+			if (occ.norig_ == 1 && occ.nupdated_ == 1)
+			{
+				candidates.push_back({i, occ.updated_});
+			}
+		}
+
+		// patience sort candidates by updated position
+		std::vector<INDEX> tails;
+		std::vector<INDEX> prevs(candidates.size(), -1);
+		for (INDEX i = 0, n = candidates.size(); i < n; ++i)
+		{
+			auto it = std::lower_bound(tails.begin(), tails.end(),
+				candidates[i].second,
+				[&candidates](INDEX tail, INDEX updated)
+				{
+					return candidates[tail].second < updated;
+				});
+			if (it != tails.begin())
+			{
+				prevs[i] = *std::prev(it);
+			}
+			if (it == tails.end())
+			{
+				tails.push_back(i);
+			}
+			else
+			{
+				*it = i;
+			}
+		}
+
+		std::vector<PointT<INDEX>> anchors;
+		for (INDEX i = tails.empty() ? -1 : tails.back(); i >= 0; i = prevs[i])
+		{
+			anchors.push_back(candidates[i]);
+		}
+		std::reverse(anchors.begin(), anchors.end());
+		return anchors;
+	}
+
+private:
+	ITER orig_begin_;
+
+	ITER updated_begin_;
+
+	/// Buffers shared by the myers searches of every region
+	DiffWorkspace<INDEX> workspace_;
+};
+
+/// Return list of differences between orig and updated arrays aligned
+/// on elements that are unique in both arrays
+/// Result is not necessarily minimum-cost, but tends to align distinctive
+/// lines (e.g.: function signatures) instead of repetitive ones (e.g.: braces)
+template <typename ARR, typename COMPARATOR=std::equal_to<ArrValT<ARR>>,
+	typename INDEX=IndexT, typename HASHER=std::hash<ArrValT<ARR>>>
+std::vector<DiffArrT<ARR,INDEX>> patience_diff (
+	const ARR& orig, const ARR& updated)
+{
+	IndexedArr<ARR> orig_view(orig);
+	IndexedArr<ARR> updated_view(updated);
+	std::vector<DiffArrT<ARR,INDEX>> diffs;
+	PatienceDiffer<typename IndexedArr<ARR>::IterT,
+		COMPARATOR,HASHER,INDEX> differ(
+		orig_view.begin(), updated_view.begin());
+	differ.diff(diffs, 0, orig_view.size(), 0, updated_view.size());
+	return diffs;
+}
+
+}
+
+#endif // PKG_DIFF_PATIENCE_HPP
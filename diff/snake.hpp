@@ -0,0 +1,190 @@
+///
+/// snake.hpp
+/// diff
+///
+/// Purpose:
+/// Define snake extension (runs of equal elements) used by diff searches
+///
+/// integral elements compared with std::equal_to are compared 16 (SSE2) or
+/// 32 (AVX2) bytes at a time when the target supports it
+///
+
+#ifndef PKG_DIFF_SNAKE_HPP
+#define PKG_DIFF_SNAKE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace diff
+{
+
+/// True if elements at ITER can be compared bytewise in place of COMPARATOR
+template <typename COMPARATOR, typename ITER>
+struct is_bytewise_comparable final : std::false_type {};
+
+template <typename COMPARATOR, typename T>
+struct is_bytewise_comparable<COMPARATOR,const T*> final :
+	std::integral_constant<bool, std::is_integral<T>::value && (
+		std::is_same<COMPARATOR,std::equal_to<T>>::value ||
+		std::is_same<COMPARATOR,std::equal_to<>>::value)> {};
+
+/// Return the index of the lowest set bit of nonzero mask
+inline size_t lowest_bit (uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(mask);
+#else
+	size_t i = 0;
+	for (; 0 == (mask & 1); mask >>= 1, ++i);
+	return i;
+#endif
+}
+
+/// Return the index of the highest set bit of nonzero mask
+inline size_t highest_bit (uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return 31 - __builtin_clz(mask);
+#else
+	size_t i = 31;
+	for (; 0 == (mask & 0x80000000); mask <<= 1, --i);
+	return i;
+#endif
+}
+
+/// Return the number of equal leading bytes of lhs and rhs up to nbytes
+inline size_t equal_prefix_bytes (
+	const char* lhs, const char* rhs, size_t nbytes)
+{
+	size_t i = 0;
+#ifdef __AVX2__
+	for (; i + 32 <= nbytes; i += 32)
+	{
+		__m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+		__m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+		uint32_t diffmask = ~static_cast<uint32_t>(
+			_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+		if (diffmask)
+		{
+			return i + lowest_bit(diffmask);
+		}
+	}
+#endif
+#ifdef __SSE2__
+	for (; i + 16 <= nbytes; i += 16)
+	{
+		__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+		__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+		uint32_t diffmask = 0xFFFF & ~static_cast<uint32_t>(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)));
+		if (diffmask)
+		{
+			return i + lowest_bit(diffmask);
+		}
+	}
+#endif
+	for (; i < nbytes && lhs[i] == rhs[i]; ++i);
+	return i;
+}
+
+/// Return the number of equal trailing bytes of the nbytes ending at
+/// lhs_end and rhs_end
+inline size_t equal_suffix_bytes (
+	const char* lhs_end, const char* rhs_end, size_t nbytes)
+{
+	size_t i = 0;
+#ifdef __AVX2__
+	for (; i + 32 <= nbytes; i += 32)
+	{
+		__m256i l = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(lhs_end - i - 32));
+		__m256i r = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(rhs_end - i - 32));
+		uint32_t diffmask = ~static_cast<uint32_t>(
+			_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+		if (diffmask)
+		{
+			return i + 31 - highest_bit(diffmask);
+		}
+	}
+#endif
+#ifdef __SSE2__
+	for (; i + 16 <= nbytes; i += 16)
+	{
+		__m128i l = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(lhs_end - i - 16));
+		__m128i r = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(rhs_end - i - 16));
+		uint32_t diffmask = 0xFFFF & ~static_cast<uint32_t>(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)));
+		if (diffmask)
+		{
+			return i + 15 - highest_bit(diffmask);
+		}
+	}
+#endif
+	for (; i < nbytes && lhs_end[-1 - (ptrdiff_t) i] ==
+		rhs_end[-1 - (ptrdiff_t) i]; ++i);
+	return i;
+}
+
+/// Return the number of consecutive equal elements starting at
+/// orig and updated, up to limit elements
+template <typename COMPARATOR, typename ITER, typename INDEX>
+INDEX snake_length (const COMPARATOR& comparator,
+	ITER orig, ITER updated, INDEX limit)
+{
+	if (limit <= 0)
+	{
+		return 0;
+	}
+	if constexpr (is_bytewise_comparable<COMPARATOR,ITER>::value)
+	{
+		constexpr size_t width = sizeof(*orig);
+		return equal_prefix_bytes(
+			reinterpret_cast<const char*>(orig),
+			reinterpret_cast<const char*>(updated), limit * width) / width;
+	}
+	else
+	{
+		INDEX i = 0;
+		for (; i < limit && comparator(orig[i], updated[i]); ++i);
+		return i;
+	}
+}
+
+/// Return the number of consecutive equal elements ending right before
+/// orig_end and updated_end, up to limit elements
+template <typename COMPARATOR, typename ITER, typename INDEX>
+INDEX reverse_snake_length (const COMPARATOR& comparator,
+	ITER orig_end, ITER updated_end, INDEX limit)
+{
+	if (limit <= 0)
+	{
+		return 0;
+	}
+	if constexpr (is_bytewise_comparable<COMPARATOR,ITER>::value)
+	{
+		constexpr size_t width = sizeof(*orig_end);
+		return equal_suffix_bytes(
+			reinterpret_cast<const char*>(orig_end),
+			reinterpret_cast<const char*>(updated_end), limit * width) / width;
+	}
+	else
+	{
+		INDEX i = 0;
+		for (; i < limit && comparator(orig_end[-1 - i],
+			updated_end[-1 - i]); ++i);
+		return i;
+	}
+}
+
+}
+
+#endif // PKG_DIFF_SNAKE_HPP
@@ -1,53 +1,235 @@
 #include "diff/msg.hpp"
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef PKG_DIFF_MSG_HPP
 
 namespace diff
 {
 
-using MsgDiffT = std::vector<DiffArrT<types::StringsT>>;
+using LineViewsT = std::vector<std::string_view>;
+
+using LineIdsT = std::vector<IndexT>;
+
+using IdDiffsT = std::vector<Diff<IndexT>>;
+
+/// Number of regions parallel_diff_msg aims to give each thread,
+/// so threads finishing early can take over remaining regions
+const size_t parallel_regions_per_thread = 4;
 
-static std::string to_string (const MsgDiffT& diffs)
+/// Interns each distinct line into an integer id,
+/// so searches only compare integers
+struct LineInterner final
 {
-	IndexT ndiffs = diffs.size();
-	bool show[ndiffs];
-	std::memset(show, false, sizeof(bool) * ndiffs);
-	// mark exact line to show
-	for (IndexT i = 0; i < ndiffs; ++i)
+	/// Append ids of lines to ids
+	template <typename LINES>
+	void intern (LineIdsT& ids, const LINES& lines)
 	{
-		if (diffs[i].action_ != EQ)
+		ids.reserve(ids.size() + lines.size());
+		for (const auto& line : lines)
 		{
-			IndexT begin = std::max(0, i - lines_before);
-			IndexT end = std::min(ndiffs - 1, i + lines_after);
-			std::memset(show + begin, true, sizeof(bool) * (end - begin + 1));
+			auto it = line_ids_.emplace(line, line_ids_.size()).first;
+			ids.push_back(it->second);
 		}
 	}
-	size_t oidx = 0;
-	size_t uidx = 0;
-	std::stringstream out;
-	for (IndexT i = 0; i < ndiffs; ++i)
+
+	std::unordered_map<std::string_view,IndexT> line_ids_;
+};
+
+/// Intern each distinct line of expect and got into an integer id
+template <typename LINES>
+static void intern_lines (LineIdsT& exids, LineIdsT& goids,
+	const LINES& expect, const LINES& got)
+{
+	LineInterner interner;
+	interner.line_ids_.reserve(expect.size() + got.size());
+	interner.intern(exids, expect);
+	interner.intern(goids, got);
+}
+
+/// Return diff of nexpect ids from exids and ngot ids from goids using algo
+/// Indices of the diffs are relative to exids and goids
+static IdDiffsT id_diff (DiffWorkspace<IndexT>& workspace,
+	const IndexT* exids, IndexT nexpect,
+	const IndexT* goids, IndexT ngot, Algorithm algo)
+{
+	using ComparatorT = std::equal_to<IndexT>;
+	using HasherT = std::hash<IndexT>;
+	IdDiffsT diffs;
+	switch (algo)
+	{
+		case PATIENCE:
+			PatienceDiffer<const IndexT*,ComparatorT,HasherT>(
+				exids, goids).diff(diffs, 0, nexpect, 0, ngot);
+			break;
+		case HISTOGRAM:
+			HistogramDiffer<const IndexT*,ComparatorT,HasherT>(
+				exids, goids).diff(diffs, 0, nexpect, 0, ngot);
+			break;
+		default:
+			myers_range_diff<ComparatorT,IndexT>(workspace, diffs,
+				exids, IndexT(0), nexpect, goids, IndexT(0), ngot);
+	}
+	return diffs;
+}
+
+/// Write lines of id diffs in [begin, end) to writer,
+/// where diff indices are relative to eoffset of expect and goffset of got
+template <typename LINES>
+static void write_id_diffs (DiffWriter<typename LINES::value_type>& writer,
+	IdDiffsT::const_iterator begin, IdDiffsT::const_iterator end,
+	const LINES& expect, const LINES& got, size_t eoffset, size_t goffset)
+{
+	for (auto it = begin; it != end; ++it)
 	{
-		if (show[i])
+		writer.write(it->action_ == ADD ?
+			got[goffset + it->updated_] : expect[eoffset + it->orig_],
+			it->action_);
+	}
+}
+
+/// Write diffs of expect and got to writer in batches of
+/// at most batch_limit lines from each
+/// Differences after the last equal line of a batch are diffed again
+/// with the next batch
+template <typename LINES>
+static void batched_diff (DiffWriter<typename LINES::value_type>& writer,
+	const LINES& expect, const LINES& got,
+	size_t batch_limit, Algorithm algo)
+{
+	LineIdsT exids;
+	LineIdsT goids;
+	intern_lines(exids, goids, expect, got);
+	batch_limit = std::clamp<size_t>(batch_limit, 1,
+		std::numeric_limits<IndexT>::max());
+
+	DiffWorkspace<IndexT> workspace;
+	size_t nexpect = exids.size();
+	size_t ngot = goids.size();
+	size_t eoffset = 0;
+	size_t goffset = 0;
+	while (true)
+	{
+		size_t ebatch = std::min(batch_limit, nexpect - eoffset);
+		size_t gbatch = std::min(batch_limit, ngot - goffset);
+		IdDiffsT diffs = id_diff(workspace, exids.data() + eoffset, ebatch,
+			goids.data() + goffset, gbatch, algo);
+		if (eoffset + ebatch == nexpect && goffset + gbatch == ngot)
 		{
-			diff_line_format(out, diffs[i].val_,
-				diffs[i].action_, oidx, uidx);
+			write_id_diffs(writer, diffs.begin(), diffs.end(),
+				expect, got, eoffset, goffset);
+			break;
 		}
-		switch (diffs[i].action_)
+
+		// revalidate contiguous non-EQ that continues pass the end of batch
+		auto diff_end = diffs.end();
+		size_t next_eoffset = eoffset + ebatch;
+		size_t next_goffset = goffset + gbatch;
+		auto last_eq = std::find_if(diffs.rbegin(), diffs.rend(),
+			[](const Diff<IndexT>& d) { return d.action_ == EQ; });
+		if (diffs.rend() != last_eq)
 		{
-			case EQ:
-				++oidx;
-				++uidx;
-				break;
-			case ADD:
-				++uidx;
-				break;
-			case DEL:
-				++oidx;
-				break;
+			diff_end = last_eq.base();
+			next_eoffset = eoffset + last_eq->orig_ + 1;
+			next_goffset = goffset + last_eq->updated_ + 1;
 		}
+		write_id_diffs(writer, diffs.begin(), diff_end,
+			expect, got, eoffset, goffset);
+		eoffset = next_eoffset;
+		goffset = next_goffset;
+	}
+}
+
+/// Write diffs of expect and got to writer, where both are split into
+/// regions at lines occurring exactly once in each of them,
+/// and regions are diffed concurrently by up to nthreads threads
+template <typename LINES>
+static void parallel_diff (DiffWriter<typename LINES::value_type>& writer,
+	const LINES& expect, const LINES& got,
+	size_t nthreads, Algorithm algo)
+{
+	LineIdsT exids;
+	LineIdsT goids;
+	intern_lines(exids, goids, expect, got);
+	IndexT nexpect = exids.size();
+	IndexT ngot = goids.size();
+	auto anchors = PatienceDiffer<const IndexT*,std::equal_to<IndexT>,
+		std::hash<IndexT>>(exids.data(), goids.data()).unique_anchors(
+			0, nexpect, 0, ngot);
+
+	// each region begins at its anchor, which every algorithm aligns
+	// as part of the common prefix
+	struct Region final
+	{
+		IndexT obegin_;
+
+		IndexT oend_;
+
+		IndexT ubegin_;
+
+		IndexT uend_;
+	};
+	nthreads = std::max<size_t>(nthreads, 1);
+	size_t region_size = std::max<size_t>(1, (exids.size() + goids.size()) /
+		(nthreads * parallel_regions_per_thread));
+	std::vector<Region> regions;
+	IndexT obegin = 0;
+	IndexT ubegin = 0;
+	for (const PointT<IndexT>& anchor : anchors)
+	{
+		if (static_cast<size_t>(anchor.first - obegin) +
+			static_cast<size_t>(anchor.second - ubegin) >= region_size)
+		{
+			regions.push_back(Region{
+				obegin, anchor.first, ubegin, anchor.second});
+			obegin = anchor.first;
+			ubegin = anchor.second;
+		}
+	}
+	regions.push_back(Region{obegin, nexpect, ubegin, ngot});
+
+	std::vector<IdDiffsT> region_diffs(regions.size());
+	std::atomic<size_t> next_region(0);
+	auto work = [&]()
+	{
+		DiffWorkspace<IndexT> workspace;
+		for (size_t i = next_region++; i < regions.size(); i = next_region++)
+		{
+			const Region& region = regions[i];
+			region_diffs[i] = id_diff(workspace,
+				exids.data() + region.obegin_, region.oend_ - region.obegin_,
+				goids.data() + region.ubegin_, region.uend_ - region.ubegin_,
+				algo);
+		}
+	};
+	std::vector<std::future<void>> workers;
+	for (size_t i = 1, n = std::min(nthreads, regions.size()); i < n; ++i)
+	{
+		workers.push_back(std::async(std::launch::async, work));
+	}
+	work();
+	for (std::future<void>& worker : workers)
+	{
+		worker.get();
+	}
+
+	for (size_t i = 0, n = regions.size(); i < n; ++i)
+	{
+		write_id_diffs(writer, region_diffs[i].begin(), region_diffs[i].end(),
+			expect, got, regions[i].obegin_, regions[i].ubegin_);
+		region_diffs[i] = IdDiffsT();
 	}
-	return out.str();
 }
 
 static void process_lines (types::StringsT& lines, std::istream& str,
@@ -68,86 +250,264 @@ static void process_lines (types::StringsT& lines, std::istream& str,
 	}
 }
 
-static void safe_diff_msg_helper (MsgDiffT& diffs,
-	const types::StringsT& expect,
-	const types::StringsT& got,
-	size_t batch_limit)
+/// Read-only memory mapping of a file that is unmapped on destruction
+struct MappedFile final
 {
-	size_t nexpect = expect.size();
-	size_t ngot = got.size();
+	MappedFile (const std::string& path)
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			throw std::runtime_error(fmts::sprintf("failed to open %s: %s",
+				path.c_str(), std::strerror(errno)));
+		}
+		struct stat info;
+		if (fstat(fd, &info) < 0)
+		{
+			int err = errno;
+			close(fd);
+			throw std::runtime_error(fmts::sprintf("failed to stat %s: %s",
+				path.c_str(), std::strerror(err)));
+		}
+		size_ = info.st_size;
+		if (size_ > 0)
+		{
+			void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			int err = errno;
+			close(fd);
+			if (MAP_FAILED == data)
+			{
+				throw std::runtime_error(fmts::sprintf("failed to map %s: %s",
+					path.c_str(), std::strerror(err)));
+			}
+			data_ = static_cast<const char*>(data);
+		}
+		else
+		{
+			close(fd);
+		}
+	}
 
-	if (nexpect <= batch_limit && ngot <= batch_limit)
+	~MappedFile (void)
 	{
-		MsgDiffT mdiffs = myers_diff(expect, got);
-		std::stringstream out;
-		for (IndexT i = 0, n = mdiffs.size(); i < n; ++i)
+		if (nullptr != data_)
 		{
-			diffs.push_back(mdiffs[i]);
+			munmap(const_cast<char*>(data_), size_);
 		}
-		return;
 	}
 
-	auto exit = expect.begin();
-	auto goit = got.begin();
-	types::StringsT exbatch(exit, exit + std::min(batch_limit, nexpect));
-	types::StringsT gobatch(goit, goit + std::min(batch_limit, ngot));
+	MappedFile (const MappedFile& other) = delete;
+
+	MappedFile& operator = (const MappedFile& other) = delete;
+
+	std::string_view view (void) const
+	{
+		return std::string_view(data_, size_);
+	}
+
+private:
+	const char* data_ = nullptr;
 
-	MsgDiffT mdiffs = myers_diff(exbatch, gobatch);
+	size_t size_ = 0;
+};
 
-	IndexT diff_end, eoffset, goffset;
-	diff_end = mdiffs.size();
-	eoffset = std::min(batch_limit, nexpect);
-	goffset = std::min(batch_limit, ngot);
-	for (IndexT i = 0, n = mdiffs.size(); i < n; ++i)
+/// Same as process_lines, except lines are views into content,
+/// and trimming only moves the view bounds
+static void process_line_views (LineViewsT& lines, std::string_view content,
+	bool ignore_empty_lines, bool trim_spaces)
+{
+	auto is_space = [](char c)
 	{
-		if (mdiffs[i].action_ == EQ)
+		return std::isspace(static_cast<unsigned char>(c));
+	};
+	size_t begin = 0;
+	while (begin < content.size())
+	{
+		size_t end = content.find('\n', begin);
+		if (std::string_view::npos == end)
+		{
+			end = content.size();
+		}
+		std::string_view line = content.substr(begin, end - begin);
+		begin = end + 1;
+		if (trim_spaces)
+		{
+			while (line.size() > 0 && is_space(line.front()))
+			{
+				line.remove_prefix(1);
+			}
+			while (line.size() > 0 && is_space(line.back()))
+			{
+				line.remove_suffix(1);
+			}
+		}
+		if (false == ignore_empty_lines || line.size() > 0)
 		{
-			diff_end = i + 1;
-			eoffset = mdiffs[i].orig_ + 1;
-			goffset = mdiffs[i].updated_ + 1;
+			lines.push_back(line);
 		}
 	}
+}
 
-	for (IndexT i = 0; i < diff_end; ++i)
+std::string diff_msg (
+	const types::StringsT& expect,
+	const types::StringsT& got,
+	Algorithm algo, size_t refine_edits)
+{
+	LineIdsT exids;
+	LineIdsT goids;
+	intern_lines(exids, goids, expect, got);
+	std::stringstream out;
+	DiffWriter<std::string> writer(out);
+	if (refine_edits > 0)
 	{
-		diffs.push_back(mdiffs[i]);
+		writer.refine_lines(refine_edits);
 	}
+	DiffWorkspace<IndexT> workspace;
+	IdDiffsT diffs = id_diff(workspace, exids.data(), exids.size(),
+		goids.data(), goids.size(), algo);
+	write_id_diffs(writer, diffs.begin(), diffs.end(), expect, got, 0, 0);
+	writer.finish();
+	return out.str();
+}
 
-	// revalidate contiguous non-EQ that continues pass the end of line
-	// and affix to existing messages
-	safe_diff_msg_helper(diffs,
-		types::StringsT(exit + eoffset, expect.end()),
-		types::StringsT(goit + goffset, got.end()), batch_limit);
+std::string safe_diff_msg (
+	const types::StringsT& expect,
+	const types::StringsT& got,
+	size_t batch_limit, Algorithm algo)
+{
+	std::stringstream out;
+	DiffWriter<std::string> writer(out);
+	batched_diff(writer, expect, got, batch_limit, algo);
+	writer.finish();
+	return out.str();
 }
 
-std::string diff_msg (
+std::string parallel_diff_msg (
 	const types::StringsT& expect,
-	const types::StringsT& got)
+	const types::StringsT& got,
+	size_t nthreads, Algorithm algo)
 {
-	MsgDiffT diffs = myers_diff(expect, got);
-	return to_string(diffs);
+	std::stringstream out;
+	DiffWriter<std::string> writer(out);
+	parallel_diff(writer, expect, got, nthreads, algo);
+	writer.finish();
+	return out.str();
 }
 
-std::string safe_diff_msg (
+void write_diff_msg (std::ostream& out,
+	const types::StringsT& expect,
+	const types::StringsT& got,
+	size_t batch_limit, Algorithm algo, size_t refine_edits)
+{
+	DiffWriter<std::string> writer(out, true);
+	if (refine_edits > 0)
+	{
+		writer.refine_lines(refine_edits);
+	}
+	batched_diff(writer, expect, got, batch_limit, algo);
+	writer.finish();
+}
+
+void write_diff_msg (const LineSinkT& sink,
 	const types::StringsT& expect,
 	const types::StringsT& got,
-	size_t batch_limit)
+	size_t batch_limit, Algorithm algo, size_t refine_edits)
 {
-	MsgDiffT diff;
-	safe_diff_msg_helper(diff, expect, got, batch_limit);
-	return to_string(diff);
+	DiffWriter<std::string> writer(sink, true);
+	if (refine_edits > 0)
+	{
+		writer.refine_lines(refine_edits);
+	}
+	batched_diff(writer, expect, got, batch_limit, algo);
+	writer.finish();
 }
 
 std::string diff_lines (
 	std::istream& expect, std::istream& got,
-	bool ignore_empty_lines, bool trim_spaces)
+	bool ignore_empty_lines, bool trim_spaces, Algorithm algo)
 {
 	types::StringsT exlines;
 	types::StringsT golines;
 	process_lines(exlines, expect, ignore_empty_lines, trim_spaces);
 	process_lines(golines, got, ignore_empty_lines, trim_spaces);
 
-	return safe_diff_msg(exlines, golines);
+	return safe_diff_msg(exlines, golines,
+		std::numeric_limits<IndexT>::max(), algo);
+}
+
+std::string diff_files (
+	const std::string& path_a, const std::string& path_b,
+	const DiffOptions& opts)
+{
+	MappedFile file_a(path_a);
+	MappedFile file_b(path_b);
+	LineViewsT alines;
+	LineViewsT blines;
+	process_line_views(alines, file_a.view(),
+		opts.ignore_empty_lines_, opts.trim_spaces_);
+	process_line_views(blines, file_b.view(),
+		opts.ignore_empty_lines_, opts.trim_spaces_);
+
+	std::stringstream out;
+	DiffWriter<std::string_view> writer(out);
+	if (opts.refine_edits_ > 0)
+	{
+		writer.refine_lines(opts.refine_edits_);
+	}
+	batched_diff(writer, alines, blines,
+		std::numeric_limits<IndexT>::max(), opts.algo_);
+	writer.finish();
+	return out.str();
+}
+
+size_t merge_lines (types::StringsT& merged,
+	const types::StringsT& base,
+	const types::StringsT& ours,
+	const types::StringsT& theirs)
+{
+	LineInterner interner;
+	interner.line_ids_.reserve(base.size() + ours.size() + theirs.size());
+	LineIdsT base_ids;
+	LineIdsT ours_ids;
+	LineIdsT theirs_ids;
+	interner.intern(base_ids, base);
+	interner.intern(ours_ids, ours);
+	interner.intern(theirs_ids, theirs);
+
+	auto append = [&merged](const types::StringsT& lines,
+		const PointT<IndexT>& range)
+	{
+		merged.insert(merged.end(), lines.begin() + range.first,
+			lines.begin() + range.second);
+	};
+	size_t nconflicts = 0;
+	merged.clear();
+	merged.reserve(std::max(ours.size(), theirs.size()));
+	for (const MergeChunk<IndexT>& chunk :
+		diff3(base_ids, ours_ids, theirs_ids))
+	{
+		switch (chunk.action_)
+		{
+			case STABLE:
+			case TAKE_OURS:
+				append(ours, chunk.ours_);
+				break;
+			case TAKE_THEIRS:
+				append(theirs, chunk.theirs_);
+				break;
+			case CONFLICT:
+				++nconflicts;
+				merged.emplace_back(ours_marker);
+				append(ours, chunk.ours_);
+				merged.emplace_back(base_marker);
+				append(base, chunk.base_);
+				merged.emplace_back(separator_marker);
+				append(theirs, chunk.theirs_);
+				merged.emplace_back(theirs_marker);
+				break;
+		}
+	}
+	return nconflicts;
 }
 
 }
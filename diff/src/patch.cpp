@@ -0,0 +1,194 @@
+#include "diff/patch.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "fmts/fmts.hpp"
+
+#include "diff/linear_diff.hpp"
+
+#ifdef PKG_DIFF_PATCH_HPP
+
+namespace diff
+{
+
+/// Return zigzag encoding of value, so small negative values stay small
+static uint64_t zigzag (int64_t value)
+{
+	return (static_cast<uint64_t>(value) << 1) ^
+		static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag (uint64_t value)
+{
+	return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void write_varint (std::string& out, uint64_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+	{
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+bool read_varint (uint64_t& value, std::string_view in, size_t& pos)
+{
+	value = 0;
+	for (size_t shift = 0; pos < in.size() && shift < 64; shift += 7)
+	{
+		uint8_t byte = in[pos++];
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if (0 == (byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string encode_patch (const std::vector<Diff<char>>& diffs,
+	size_t norig, size_t nupdated)
+{
+	std::string patch;
+	write_varint(patch, norig);
+	write_varint(patch, nupdated);
+
+	int64_t cursor = 0;
+	int64_t copy_begin = 0;
+	int64_t ncopy = 0;
+	std::string inserts;
+	auto flush_copy = [&]()
+	{
+		if (ncopy > 0)
+		{
+			write_varint(patch, static_cast<uint64_t>(ncopy) << 1 | COPY_OP);
+			write_varint(patch, zigzag(copy_begin - cursor));
+			cursor = copy_begin + ncopy;
+			ncopy = 0;
+		}
+	};
+	auto flush_insert = [&]()
+	{
+		if (inserts.size() > 0)
+		{
+			write_varint(patch,
+				static_cast<uint64_t>(inserts.size()) << 1 | INSERT_OP);
+			patch.append(inserts);
+			inserts.clear();
+		}
+	};
+	for (const Diff<char>& d : diffs)
+	{
+		switch (d.action_)
+		{
+			case EQ:
+				flush_insert();
+				if (ncopy > 0 && copy_begin + ncopy != d.orig_)
+				{
+					flush_copy();
+				}
+				if (0 == ncopy)
+				{
+					copy_begin = d.orig_;
+				}
+				++ncopy;
+				break;
+			case ADD:
+				flush_copy();
+				inserts.push_back(d.val_);
+				break;
+			case DEL:
+				break;
+		}
+	}
+	flush_copy();
+	flush_insert();
+	return patch;
+}
+
+std::string make_patch (std::string_view orig, std::string_view updated)
+{
+	// frontiers span both inputs, so their sizes are limited together
+	if (false == linear_diff_fits<IndexT>(orig.size(), updated.size()))
+	{
+		throw std::runtime_error(fmts::sprintf(
+			"cannot patch %zu bytes into %zu bytes: exceeds diff index limit",
+			orig.size(), updated.size()));
+	}
+	return encode_patch(linear_myers_diff(orig, updated),
+		orig.size(), updated.size());
+}
+
+std::string apply_patch (std::string_view orig, std::string_view patch)
+{
+	size_t pos = 0;
+	uint64_t norig;
+	uint64_t nupdated;
+	if (false == read_varint(norig, patch, pos) ||
+		false == read_varint(nupdated, patch, pos))
+	{
+		throw std::runtime_error("truncated patch header");
+	}
+	if (norig != orig.size())
+	{
+		throw std::runtime_error(fmts::sprintf(
+			"patch made for %zu bytes cannot apply to %zu bytes",
+			static_cast<size_t>(norig), orig.size()));
+	}
+
+	// declared size is not trusted for the reservation
+	std::string updated;
+	updated.reserve(std::min<uint64_t>(nupdated, norig + patch.size()));
+	int64_t cursor = 0;
+	while (pos < patch.size())
+	{
+		uint64_t header;
+		if (false == read_varint(header, patch, pos))
+		{
+			throw std::runtime_error("truncated patch operation");
+		}
+		uint64_t length = header >> 1;
+		if (length > nupdated - updated.size())
+		{
+			throw std::runtime_error("patch exceeds its declared size");
+		}
+		if ((header & 1) == COPY_OP)
+		{
+			uint64_t distance;
+			if (false == read_varint(distance, patch, pos))
+			{
+				throw std::runtime_error("truncated patch copy");
+			}
+			int64_t begin = cursor + unzigzag(distance);
+			if (begin < 0 || static_cast<uint64_t>(begin) > norig ||
+				length > norig - begin)
+			{
+				throw std::runtime_error("patch copies outside of orig");
+			}
+			updated.append(orig.substr(begin, length));
+			cursor = begin + length;
+		}
+		else
+		{
+			if (length > patch.size() - pos)
+			{
+				throw std::runtime_error("truncated patch insert");
+			}
+			updated.append(patch.substr(pos, length));
+			pos += length;
+		}
+	}
+	if (updated.size() != nupdated)
+	{
+		throw std::runtime_error(fmts::sprintf(
+			"patch produced %zu bytes instead of %zu bytes",
+			updated.size(), static_cast<size_t>(nupdated)));
+	}
+	return updated;
+}
+
+}
+
+#endif
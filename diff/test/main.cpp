@@ -1,3 +1,12 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <new>
+
 #include "gtest/gtest.h"
 
 #include "diff/diff.hpp"
@@ -13,6 +22,69 @@ int main (int argc, char** argv)
 #ifndef DISABLE_DIFF_TEST
 
 
+static std::atomic<bool> count_allocs(false);
+
+static std::atomic<size_t> nallocs(0);
+
+
+/// Count calls to operator new for the lifetime of the counter,
+/// other tests allocate without being counted
+struct AllocCounter final
+{
+	AllocCounter (void)
+	{
+		nallocs = 0;
+		count_allocs = true;
+	}
+
+	~AllocCounter (void)
+	{
+		count_allocs = false;
+	}
+
+	size_t count (void) const
+	{
+		return nallocs.load();
+	}
+};
+
+
+void* operator new (size_t size)
+{
+	if (count_allocs.load(std::memory_order_relaxed))
+	{
+		++nallocs;
+	}
+	if (void* ptr = std::malloc(size))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+	if (count_allocs.load(std::memory_order_relaxed))
+	{
+		++nallocs;
+	}
+	return std::malloc(size);
+}
+
+
+void operator delete (void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+
+void operator delete (void* ptr, size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+
 TEST(DIFF, MyersMinEdit)
 {
 	EXPECT_EQ(0, diff::myers_diff_min_edit<std::string>(
@@ -24,6 +96,53 @@ TEST(DIFF, MyersMinEdit)
 }
 
 
+TEST(DIFF, MyersDiffWithin)
+{
+	auto same = diff::myers_diff_within<std::string>(
+		"ABCABBA", "ABCABBA", 0);
+	EXPECT_EQ(diff::IDENTICAL, same.bound_);
+	EXPECT_EQ(0, same.nedits_);
+
+	auto within = diff::myers_diff_within<std::string>(
+		"ABCABBA", "CBABAC", 5);
+	EXPECT_EQ(diff::WITHIN_BUDGET, within.bound_);
+	EXPECT_EQ(5, within.nedits_);
+
+	auto exceeded = diff::myers_diff_within<std::string>(
+		"ABCABBA", "CBABAC", 4);
+	EXPECT_EQ(diff::EXCEEDED_BUDGET, exceeded.bound_);
+	EXPECT_LT(4, exceeded.nedits_);
+
+	// length difference alone exceeds the budget
+	auto lengthy = diff::myers_diff_within<std::string>(
+		"ABCDEFG", "A", 5);
+	EXPECT_EQ(diff::EXCEEDED_BUDGET, lengthy.bound_);
+	EXPECT_EQ(6, lengthy.nedits_);
+
+	// budget larger than n + m
+	auto generous = diff::myers_diff_within<std::string>(
+		"ABCDEFG", "HIJKLM", 100);
+	EXPECT_EQ(diff::WITHIN_BUDGET, generous.bound_);
+	EXPECT_EQ(13, generous.nedits_);
+
+	std::vector<int32_t> orig(10000);
+	for (size_t i = 0; i < orig.size(); ++i)
+	{
+		orig[i] = i % 7;
+	}
+	std::vector<int32_t> updated = orig;
+	updated[100] = -1;
+	updated[5000] = -1;
+	updated.erase(updated.begin() + 9000);
+	EXPECT_EQ(diff::EXCEEDED_BUDGET,
+		diff::myers_diff_within(orig, updated, 4).bound_);
+	auto large = diff::myers_diff_within(orig, updated, 5);
+	EXPECT_EQ(diff::WITHIN_BUDGET, large.bound_);
+	EXPECT_EQ(5, large.nedits_);
+	EXPECT_EQ(5, diff::myers_diff_min_edit(orig, updated));
+}
+
+
 TEST(DIFF, MyersDiff)
 {
 	std::string s = "ABCABBA";
@@ -78,6 +197,684 @@ TEST(DIFF, MyersDiff)
 }
 
 
+TEST(DIFF, MyersDiff_Workspace)
+{
+	std::vector<std::pair<std::string,std::string>> cases = {
+		{"ABCABBA", "CBABAC"},
+		{"kitten", "sitting"},
+		{"ABCDEFG", "HIJKLM"},
+		{"same", "same"},
+		{"", "added"},
+	};
+	diff::DiffWorkspace<> workspace;
+	std::vector<diff::DiffArrT<std::string>> diffs;
+	auto diff_all = [&]()
+	{
+		for (auto& c : cases)
+		{
+			diff::myers_diff(workspace, diffs, c.first, c.second);
+			diff::myers_diff_within(workspace, c.first, c.second, 3);
+			diff::myers_diff_backtrace(workspace, c.first, c.second);
+		}
+	};
+	// buffers grow on the first pass only
+	diff_all();
+	{
+		AllocCounter counter;
+		for (size_t i = 0; i < 100; ++i)
+		{
+			diff_all();
+		}
+		EXPECT_EQ(0, counter.count());
+	}
+
+	for (auto& c : cases)
+	{
+		diff::myers_diff(workspace, diffs, c.first, c.second);
+		auto expect = diff::myers_diff(c.first, c.second);
+		ASSERT_EQ(expect.size(), diffs.size());
+		for (size_t i = 0; i < expect.size(); ++i)
+		{
+			EXPECT_EQ(expect[i].val_, diffs[i].val_);
+			EXPECT_EQ(expect[i].orig_, diffs[i].orig_);
+			EXPECT_EQ(expect[i].updated_, diffs[i].updated_);
+			EXPECT_EQ(expect[i].action_, diffs[i].action_);
+		}
+		EXPECT_EQ(diff::myers_diff_trace(c.first, c.second),
+			diff::myers_diff_trace(workspace, c.first, c.second));
+	}
+}
+
+
+TEST(DIFF, MyersDiff_CommonAffixes)
+{
+	std::string orig = "HEADxyzTAIL";
+	std::string updated = "HEADabTAIL";
+	auto affixes = diff::myers_diff_affixes(orig, updated);
+	EXPECT_EQ(4, affixes.first);
+	EXPECT_EQ(4, affixes.second);
+	EXPECT_EQ(5, diff::myers_diff_min_edit(orig, updated));
+
+	auto diffs = diff::myers_diff(orig, updated);
+	ASSERT_EQ(13, diffs.size());
+	for (size_t i = 0; i < 4; ++i)
+	{
+		EXPECT_EQ(orig[i], diffs[i].val_);
+		EXPECT_EQ(i, diffs[i].orig_);
+		EXPECT_EQ(i, diffs[i].updated_);
+		EXPECT_EQ(diff::EQ, diffs[i].action_);
+	}
+	for (size_t i = 4; i < 7; ++i)
+	{
+		EXPECT_EQ(orig[i], diffs[i].val_);
+		EXPECT_EQ(i, diffs[i].orig_);
+		EXPECT_EQ(diff::DEL, diffs[i].action_);
+	}
+	for (size_t i = 7; i < 9; ++i)
+	{
+		EXPECT_EQ(updated[i - 3], diffs[i].val_);
+		EXPECT_EQ(i - 3, diffs[i].updated_);
+		EXPECT_EQ(diff::ADD, diffs[i].action_);
+	}
+	for (size_t i = 9; i < 13; ++i)
+	{
+		EXPECT_EQ(orig[i - 2], diffs[i].val_);
+		EXPECT_EQ(i - 2, diffs[i].orig_);
+		EXPECT_EQ(i - 3, diffs[i].updated_);
+		EXPECT_EQ(diff::EQ, diffs[i].action_);
+	}
+
+	// suffix never overlaps prefix
+	affixes = diff::myers_diff_affixes<std::string>("AAA", "AA");
+	EXPECT_EQ(2, affixes.first);
+	EXPECT_EQ(0, affixes.second);
+	auto shorter = diff::myers_diff<std::string>("AAA", "AA");
+	ASSERT_EQ(3, shorter.size());
+	EXPECT_EQ(diff::DEL, shorter[2].action_);
+	EXPECT_EQ(2, shorter[2].orig_);
+
+	auto same = diff::myers_diff<std::string>("ABC", "ABC");
+	ASSERT_EQ(3, same.size());
+	EXPECT_EQ(0, diff::myers_diff_min_edit<std::string>("ABC", "ABC"));
+}
+
+
+TEST(DIFF, MyersDiff_WideIndex)
+{
+	// exceed 16-bit index limit
+	std::vector<int32_t> orig(40000);
+	for (size_t i = 0, n = orig.size(); i < n; ++i)
+	{
+		orig[i] = i;
+	}
+	std::vector<int32_t> updated = orig;
+	updated.erase(updated.begin() + 35000);
+	updated.insert(updated.begin() + 38000, -1);
+
+	auto diffs = diff::myers_diff(orig, updated);
+	ASSERT_EQ(40001, diffs.size());
+	EXPECT_EQ(2, diff::myers_diff_min_edit(orig, updated));
+	EXPECT_EQ(diff::DEL, diffs[35000].action_);
+	EXPECT_EQ(35000, diffs[35000].orig_);
+	EXPECT_EQ(-1, diffs[35000].updated_);
+	EXPECT_EQ(diff::ADD, diffs[38001].action_);
+	EXPECT_EQ(-1, diffs[38001].orig_);
+	EXPECT_EQ(38000, diffs[38001].updated_);
+	EXPECT_EQ(diff::EQ, diffs[40000].action_);
+	EXPECT_EQ(39999, diffs[40000].orig_);
+	EXPECT_EQ(39999, diffs[40000].updated_);
+
+	auto ldiffs = diff::linear_myers_diff<std::vector<int32_t>,
+		std::equal_to<int32_t>,int64_t>(orig, updated);
+	ASSERT_EQ(40001, ldiffs.size());
+	EXPECT_EQ(diff::DEL, ldiffs[35000].action_);
+	EXPECT_EQ(35000, ldiffs[35000].orig_);
+	EXPECT_EQ(diff::ADD, ldiffs[38001].action_);
+	EXPECT_EQ(38000, ldiffs[38001].updated_);
+
+	// narrow index types remain available for small inputs
+	auto narrow = diff::myers_diff<std::string,std::equal_to<char>,int16_t>(
+		"ABCABBA", "CBABAC");
+	static_assert(std::is_same<int16_t,decltype(narrow[0].orig_)>::value,
+		"expecting 16-bit diff indices");
+	EXPECT_EQ(9, narrow.size());
+}
+
+
+TEST(DIFF, MyersDiff_NonContiguous)
+{
+	static_assert(diff::is_contiguous<std::string>::value,
+		"expecting strings to be viewed as pointers");
+	static_assert(diff::is_contiguous<std::vector<int>>::value,
+		"expecting vectors to be viewed as pointers");
+	static_assert(!diff::is_contiguous<std::deque<char>>::value,
+		"expecting deques to be viewed as iterators");
+	static_assert(!diff::is_contiguous<std::list<char>>::value,
+		"expecting lists to be buffered");
+
+	std::string s = "ABCABBA";
+	std::string similar = "CBABAC";
+	auto expect = diff::myers_diff(s, similar);
+
+	std::list<char> ls(s.begin(), s.end());
+	std::list<char> lsimilar(similar.begin(), similar.end());
+	std::deque<char> ds(s.begin(), s.end());
+	std::deque<char> dsimilar(similar.begin(), similar.end());
+	auto lgot = diff::myers_diff(ls, lsimilar);
+	auto dgot = diff::myers_diff(ds, dsimilar);
+	auto llinear = diff::linear_myers_diff(ls, lsimilar);
+	EXPECT_EQ(5, diff::myers_diff_min_edit(ls, lsimilar));
+	EXPECT_EQ(5, diff::myers_diff_min_edit(ds, dsimilar));
+	ASSERT_EQ(expect.size(), lgot.size());
+	ASSERT_EQ(expect.size(), dgot.size());
+	ASSERT_EQ(expect.size(), llinear.size());
+	for (size_t i = 0, n = expect.size(); i < n; ++i)
+	{
+		EXPECT_EQ(expect[i].val_, lgot[i].val_);
+		EXPECT_EQ(expect[i].orig_, lgot[i].orig_);
+		EXPECT_EQ(expect[i].updated_, lgot[i].updated_);
+		EXPECT_EQ(expect[i].action_, lgot[i].action_);
+		EXPECT_EQ(expect[i].val_, dgot[i].val_);
+		EXPECT_EQ(expect[i].orig_, dgot[i].orig_);
+		EXPECT_EQ(expect[i].updated_, dgot[i].updated_);
+		EXPECT_EQ(expect[i].action_, dgot[i].action_);
+	}
+}
+
+
+TEST(DIFF, SnakeLength)
+{
+	std::equal_to<char> char_eq;
+	std::equal_to<int32_t> int_eq;
+	std::string base(100, 'x');
+	std::vector<int32_t> ibase(100, 7);
+	for (size_t i = 0; i < base.size(); ++i)
+	{
+		base[i] = 'a' + i % 26;
+		ibase[i] = i * 977;
+	}
+	for (int32_t mismatch = 0; mismatch <= 100; ++mismatch)
+	{
+		std::string other = base;
+		std::vector<int32_t> iother = ibase;
+		if (mismatch < 100)
+		{
+			other[mismatch] = '#';
+			iother[mismatch] |= 1 << 24; // only the high byte differs
+		}
+		EXPECT_EQ(mismatch, diff::snake_length(char_eq,
+			base.data(), other.data(), 100));
+		EXPECT_EQ(std::min(mismatch, 37), diff::snake_length(char_eq,
+			base.data(), other.data(), 37));
+		EXPECT_EQ(mismatch, diff::snake_length(int_eq,
+			ibase.data(), iother.data(), 100));
+		int32_t nsuffix = mismatch < 100 ? 99 - mismatch : 100;
+		EXPECT_EQ(nsuffix, diff::reverse_snake_length(
+			char_eq, base.data() + 100, other.data() + 100, 100));
+		EXPECT_EQ(nsuffix, diff::reverse_snake_length(
+			int_eq, ibase.data() + 100, iother.data() + 100, 100));
+	}
+	EXPECT_EQ(0, diff::snake_length(char_eq,
+		base.data(), base.data(), -3));
+
+	// long character-level diff exercising vectorized snakes
+	std::string orig;
+	for (size_t i = 0; i < 300; ++i)
+	{
+		orig.push_back('a' + (i * i) % 7);
+	}
+	std::string updated = orig;
+	updated.erase(updated.begin() + 250);
+	updated.insert(updated.begin() + 130, 'z');
+	updated.erase(updated.begin() + 40, updated.begin() + 43);
+	EXPECT_EQ(5, diff::myers_diff_min_edit(orig, updated));
+	size_t nedits = 0;
+	for (auto& d : diff::myers_diff(orig, updated))
+	{
+		nedits += d.action_ != diff::EQ;
+	}
+	EXPECT_EQ(5, nedits);
+	nedits = 0;
+	for (auto& d : diff::linear_myers_diff(orig, updated))
+	{
+		nedits += d.action_ != diff::EQ;
+	}
+	EXPECT_EQ(5, nedits);
+}
+
+
+/// Return seconds elapsed since start
+static double elapsed_since (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+
+/// Compares bytes per second of the bytewise (vectorized where the target
+/// supports it) snake_length and reverse_snake_length against the scalar
+/// element loop over the same long snake
+/// Run with --gtest_also_run_disabled_tests
+TEST(DIFF, DISABLED_SnakeLengthThroughput)
+{
+	const int32_t nbytes = 1 << 20;
+	const size_t nreps = 500;
+	std::equal_to<char> bytewise_eq;
+	// not std::equal_to, so snakes fall back to comparing element by element
+	auto scalar_eq = [](char lhs, char rhs) { return lhs == rhs; };
+
+	std::string orig(nbytes, 'x');
+	for (int32_t i = 0; i < nbytes; ++i)
+	{
+		orig[i] = 'a' + (i * 7) % 26;
+	}
+	std::string updated = orig;
+
+	auto report = [&](const char* label, auto snake)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < nreps; ++i)
+		{
+			ASSERT_EQ(nbytes, snake());
+		}
+		double secs = elapsed_since(start);
+		std::cout << label << ": " <<
+			nbytes * nreps / secs / (1 << 30) << " GiB/s" << std::endl;
+	};
+	report("snake_length(bytewise)", [&]
+	{
+		return diff::snake_length(bytewise_eq,
+			orig.data(), updated.data(), nbytes);
+	});
+	report("snake_length(scalar)", [&]
+	{
+		return diff::snake_length(scalar_eq,
+			orig.data(), updated.data(), nbytes);
+	});
+	report("reverse_snake_length(bytewise)", [&]
+	{
+		return diff::reverse_snake_length(bytewise_eq,
+			orig.data() + nbytes, updated.data() + nbytes, nbytes);
+	});
+	report("reverse_snake_length(scalar)", [&]
+	{
+		return diff::reverse_snake_length(scalar_eq,
+			orig.data() + nbytes, updated.data() + nbytes, nbytes);
+	});
+}
+
+
+TEST(DIFF, LinearMyersDiff)
+{
+	types::StringsT orig = {
+		"advise",
+		"apathetic",
+		"disappear",
+		"greasy",
+		"toy",
+		"obtain",
+		"nosy",
+		"juicy",
+		"bright",
+		"jam",
+		"dust",
+		"silent",
+	};
+	std::vector<types::StringsT> updates = {
+		orig,
+		{"advise", "apathetic", "disappear", "greasy", "toy", "obtain",
+		"mate", "head", "wine", "new", "tremble", "hop"},
+		{"mate", "head", "wine", "abrupt", "whistle", "new",
+		"sneeze", "juicy", "bright", "jam", "dust", "silent"},
+		{"mate", "head", "wine", "abrupt", "obtain", "nosy",
+		"juicy", "complete", "spiky", "tremble", "bed", "hop"},
+		{"mate", "head", "greasy", "toy", "obtain", "nosy",
+		"juicy", "bright", "jam", "tremble", "bed", "hop"},
+		{"mate", "head", "wine", "abrupt", "whistle", "new",
+		"sneeze", "complete", "spiky", "tremble", "bed", "hop"},
+		{},
+	};
+	// both break ties alike on these updates, but in general only
+	// the cost is shared with myers_diff (see LinearMyersDiff_MinEdit)
+	for (auto& updated : updates)
+	{
+		auto expect = diff::myers_diff(orig, updated);
+		auto got = diff::linear_myers_diff(orig, updated);
+		ASSERT_EQ(expect.size(), got.size());
+		for (size_t i = 0, n = expect.size(); i < n; ++i)
+		{
+			EXPECT_STREQ(expect[i].val_.c_str(), got[i].val_.c_str());
+			EXPECT_EQ(expect[i].orig_, got[i].orig_);
+			EXPECT_EQ(expect[i].updated_, got[i].updated_);
+			EXPECT_EQ(expect[i].action_, got[i].action_);
+		}
+	}
+}
+
+
+TEST(DIFF, LinearMyersDiff_MinEdit)
+{
+	std::string alphabet = "ABC";
+	for (size_t seed = 0; seed < 200; ++seed)
+	{
+		std::string orig;
+		std::string updated;
+		for (size_t i = 0, n = (seed * 7) % 23; i < n; ++i)
+		{
+			orig.push_back(alphabet[(seed * 31 + i * i * 13) % alphabet.size()]);
+		}
+		for (size_t i = 0, n = (seed * 11) % 19; i < n; ++i)
+		{
+			updated.push_back(alphabet[(seed * 17 + i * 5) % alphabet.size()]);
+		}
+
+		auto diffs = diff::linear_myers_diff(orig, updated);
+		size_t nedits = 0;
+		std::string rebuilt_orig;
+		std::string rebuilt_updated;
+		for (auto& d : diffs)
+		{
+			if (d.action_ != diff::ADD)
+			{
+				ASSERT_EQ(rebuilt_orig.size(), d.orig_);
+				rebuilt_orig.push_back(d.val_);
+			}
+			if (d.action_ != diff::DEL)
+			{
+				ASSERT_EQ(rebuilt_updated.size(), d.updated_);
+				rebuilt_updated.push_back(d.val_);
+			}
+			nedits += d.action_ != diff::EQ;
+		}
+		EXPECT_STREQ(orig.c_str(), rebuilt_orig.c_str());
+		EXPECT_STREQ(updated.c_str(), rebuilt_updated.c_str());
+		EXPECT_EQ(diff::myers_diff_min_edit(orig, updated), nedits) <<
+			"orig=" << orig << ", updated=" << updated;
+	}
+}
+
+
+static void check_diff_script (const types::StringsT& orig,
+	const types::StringsT& updated,
+	const std::vector<diff::DiffArrT<types::StringsT>>& diffs)
+{
+	types::StringsT rebuilt_orig;
+	types::StringsT rebuilt_updated;
+	for (auto& d : diffs)
+	{
+		if (d.action_ != diff::ADD)
+		{
+			ASSERT_EQ(rebuilt_orig.size(), d.orig_);
+			EXPECT_STREQ(orig[d.orig_].c_str(), d.val_.c_str());
+			rebuilt_orig.push_back(d.val_);
+		}
+		if (d.action_ != diff::DEL)
+		{
+			ASSERT_EQ(rebuilt_updated.size(), d.updated_);
+			EXPECT_STREQ(updated[d.updated_].c_str(), d.val_.c_str());
+			rebuilt_updated.push_back(d.val_);
+		}
+	}
+	EXPECT_EQ(orig.size(), rebuilt_orig.size());
+	EXPECT_EQ(updated.size(), rebuilt_updated.size());
+}
+
+
+TEST(DIFF, PatienceHistogramDiff_Scripts)
+{
+	types::StringsT vocab = {"{", "}", "", "a", "b", "c", "d", "e"};
+	for (size_t seed = 0; seed < 300; ++seed)
+	{
+		types::StringsT orig;
+		types::StringsT updated;
+		for (size_t i = 0, n = 4 + seed % 9; i < n; ++i)
+		{
+			orig.push_back(vocab[(seed * 13 + i * i * 7) % vocab.size()]);
+		}
+		for (size_t i = 0, n = 3 + seed % 11; i < n; ++i)
+		{
+			updated.push_back(vocab[(seed * 5 + i * 3) % vocab.size()]);
+		}
+		check_diff_script(orig, updated, diff::patience_diff(orig, updated));
+		check_diff_script(orig, updated, diff::histogram_diff(orig, updated));
+	}
+}
+
+
+TEST(DIFF, HistogramDiff_MaxChain)
+{
+	using IterT = types::StringsT::const_iterator;
+	using DifferT = diff::HistogramDiffer<IterT,
+		std::equal_to<std::string>,std::hash<std::string>>;
+	types::StringsT updated = {"a"};
+	for (size_t n : {diff::histogram_max_chain, diff::histogram_max_chain + 1})
+	{
+		types::StringsT orig(n, "a");
+		DifferT differ(orig.begin(), updated.begin());
+		DifferT::HistogramT histogram = differ.make_histogram(0, n);
+		diff::IndexT obegin = -1, ubegin = -1, nregion = -1;
+		bool found = differ.rarest_region(obegin, ubegin, nregion,
+			histogram, 0, n, 0, 1);
+		if (n > diff::histogram_max_chain)
+		{
+			EXPECT_FALSE(found);
+			EXPECT_EQ(0, nregion);
+			continue;
+		}
+		EXPECT_TRUE(found);
+		EXPECT_EQ(0, obegin);
+		EXPECT_EQ(0, ubegin);
+		EXPECT_EQ(1, nregion);
+	}
+
+	// occurrences before obegin no longer count against the seed
+	size_t n = diff::histogram_max_chain + 1;
+	types::StringsT orig(n, "a");
+	DifferT differ(orig.begin(), updated.begin());
+	DifferT::HistogramT histogram = differ.make_histogram(0, n);
+	diff::IndexT obegin = -1, ubegin = -1, nregion = -1;
+	EXPECT_FALSE(differ.rarest_region(obegin, ubegin, nregion,
+		histogram, 0, n, 0, 1));
+	EXPECT_TRUE(differ.rarest_region(obegin, ubegin, nregion,
+		histogram, 1, n, 0, 1));
+	EXPECT_EQ(1, obegin);
+	EXPECT_EQ(0, ubegin);
+	EXPECT_EQ(1, nregion);
+}
+
+
+TEST(DIFF, Msg_Algorithms)
+{
+	types::StringsT orig = {"a", "c", "a", "e", "c"};
+	types::StringsT updated = {"e", "}", "a", "a", "{"};
+
+	EXPECT_STREQ(
+		"+  \t0\te\n"
+		"+  \t1\t}\n"
+		"  0\t2\ta\n"
+		"- 1\t \tc\n"
+		"  2\t3\ta\n"
+		"- 3\t \te\n"
+		"- 4\t \tc\n"
+		"+  \t4\t{\n",
+		diff::diff_msg(orig, updated).c_str());
+
+	// e is the only line unique in both, so it anchors the alignment
+	std::string anchored =
+		"- 0\t \ta\n"
+		"- 1\t \tc\n"
+		"- 2\t \ta\n"
+		"  3\t0\te\n"
+		"- 4\t \tc\n"
+		"+  \t1\t}\n"
+		"+  \t2\ta\n"
+		"+  \t3\ta\n"
+		"+  \t4\t{\n";
+	EXPECT_STREQ(anchored.c_str(),
+		diff::diff_msg(orig, updated, diff::PATIENCE).c_str());
+	EXPECT_STREQ(anchored.c_str(),
+		diff::diff_msg(orig, updated, diff::HISTOGRAM).c_str());
+	EXPECT_STREQ(anchored.c_str(),
+		diff::safe_diff_msg(orig, updated, 8, diff::PATIENCE).c_str());
+
+	types::StringsT func_orig = {
+		"void func1() {",
+		"x += 1",
+		"}",
+		"",
+		"void func2() {",
+		"x += 2",
+		"}",
+	};
+	types::StringsT func_updated = {
+		"void func1() {",
+		"x += 1",
+		"}",
+		"",
+		"void functhreehalves() {",
+		"x += 1.5",
+		"}",
+		"",
+		"void func2() {",
+		"x += 2",
+		"}",
+	};
+	std::string inserted =
+		"  1\t1\tx += 1\n"
+		"  2\t2\t}\n"
+		"  3\t3\t\n"
+		"+  \t4\tvoid functhreehalves() {\n"
+		"+  \t5\tx += 1.5\n"
+		"+  \t6\t}\n"
+		"+  \t7\t\n"
+		"  4\t8\tvoid func2() {\n"
+		"  5\t9\tx += 2\n"
+		"  6\t10\t}\n";
+	EXPECT_STREQ(inserted.c_str(), diff::diff_msg(
+		func_orig, func_updated, diff::PATIENCE).c_str());
+	EXPECT_STREQ(inserted.c_str(), diff::diff_msg(
+		func_orig, func_updated, diff::HISTOGRAM).c_str());
+}
+
+
+TEST(DIFF, Diff3)
+{
+	auto chunks = diff::diff3<std::string>("abcde", "aBcde", "abcdE");
+	ASSERT_EQ(4, chunks.size());
+	EXPECT_EQ(diff::STABLE, chunks[0].action_);
+	EXPECT_EQ(0, chunks[0].base_.first);
+	EXPECT_EQ(1, chunks[0].base_.second);
+	EXPECT_EQ(diff::TAKE_OURS, chunks[1].action_);
+	EXPECT_EQ(1, chunks[1].ours_.first);
+	EXPECT_EQ(2, chunks[1].ours_.second);
+	EXPECT_EQ(diff::STABLE, chunks[2].action_);
+	EXPECT_EQ(2, chunks[2].theirs_.first);
+	EXPECT_EQ(4, chunks[2].theirs_.second);
+	EXPECT_EQ(diff::TAKE_THEIRS, chunks[3].action_);
+	EXPECT_EQ(4, chunks[3].theirs_.first);
+	EXPECT_EQ(5, chunks[3].theirs_.second);
+
+	auto conflicts = diff::diff3<std::string>("abc", "aXc", "aYc");
+	ASSERT_EQ(3, conflicts.size());
+	EXPECT_EQ(diff::CONFLICT, conflicts[1].action_);
+
+	EXPECT_EQ(0, diff::diff3<std::string>("", "", "").size());
+}
+
+
+TEST(DIFF, MergeLines)
+{
+	types::StringsT base = {"a", "b", "c", "d", "e"};
+	types::StringsT merged;
+
+	EXPECT_EQ(0, diff::merge_lines(merged, base,
+		{"a", "B", "c", "d", "e"},
+		{"a", "b", "c", "D", "e", "f"}));
+	EXPECT_EQ((types::StringsT{"a", "B", "c", "D", "e", "f"}), merged);
+
+	// identical changes on both sides do not conflict
+	EXPECT_EQ(0, diff::merge_lines(merged, base,
+		{"a", "b", "Z", "d"},
+		{"a", "b", "Z", "d"}));
+	EXPECT_EQ((types::StringsT{"a", "b", "Z", "d"}), merged);
+
+	EXPECT_EQ(1, diff::merge_lines(merged, base,
+		{"a", "b", "X", "d", "e"},
+		{"0", "a", "b", "Y", "d", "e"}));
+	EXPECT_EQ((types::StringsT{
+		"0",
+		"a",
+		"b",
+		"<<<<<<< ours",
+		"X",
+		"||||||| base",
+		"c",
+		"=======",
+		"Y",
+		">>>>>>> theirs",
+		"d",
+		"e",
+	}), merged);
+}
+
+
+TEST(DIFF, Patch)
+{
+	std::string varints;
+	diff::write_varint(varints, 0);
+	diff::write_varint(varints, 127);
+	diff::write_varint(varints, 128);
+	diff::write_varint(varints, std::numeric_limits<uint64_t>::max());
+	EXPECT_EQ(1 + 1 + 2 + 10, varints.size());
+	size_t pos = 0;
+	uint64_t value;
+	ASSERT_TRUE(diff::read_varint(value, varints, pos));
+	EXPECT_EQ(0, value);
+	ASSERT_TRUE(diff::read_varint(value, varints, pos));
+	EXPECT_EQ(127, value);
+	ASSERT_TRUE(diff::read_varint(value, varints, pos));
+	EXPECT_EQ(128, value);
+	ASSERT_TRUE(diff::read_varint(value, varints, pos));
+	EXPECT_EQ(std::numeric_limits<uint64_t>::max(), value);
+	EXPECT_FALSE(diff::read_varint(value, varints, pos));
+
+	// snapshot with scattered edits, a moved block and binary bytes
+	std::string orig;
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		orig.push_back(static_cast<char>((i * 7919) % 251));
+	}
+	std::string updated = orig;
+	updated[10] = '\0';
+	updated.insert(5000, "inserted bytes");
+	updated.erase(12000, 300);
+	updated += orig.substr(0, 100);
+
+	std::string patch = diff::make_patch(orig, updated);
+	EXPECT_GT(updated.size() / 20, patch.size());
+	EXPECT_EQ(updated, diff::apply_patch(orig, patch));
+
+	EXPECT_EQ("", diff::apply_patch(orig, diff::make_patch(orig, "")));
+	EXPECT_EQ(orig, diff::apply_patch("", diff::make_patch("", orig)));
+	EXPECT_EQ(orig, diff::apply_patch(orig, diff::make_patch(orig, orig)));
+
+	EXPECT_THROW(diff::apply_patch(orig.substr(1), patch), std::runtime_error);
+	EXPECT_THROW(diff::apply_patch(orig, patch.substr(0, patch.size() - 1)),
+		std::runtime_error);
+	EXPECT_THROW(diff::apply_patch(orig, ""), std::runtime_error);
+
+	// inputs that fit the index alone may not fit it together
+	size_t max_size = std::numeric_limits<diff::IndexT>::max();
+	EXPECT_TRUE(diff::linear_diff_fits(max_size - 4, 0));
+	EXPECT_FALSE(diff::linear_diff_fits(max_size - 3, 0));
+	EXPECT_FALSE(diff::linear_diff_fits(max_size / 2 + 1, max_size / 2 + 1));
+	EXPECT_FALSE(diff::linear_diff_fits(max_size + 1, 0));
+	// sizes are rejected before any byte is read
+	std::string_view half(orig.data(), max_size / 2 + 1);
+	EXPECT_THROW(diff::make_patch(half, half), std::runtime_error);
+}
+
+
 TEST(DIFF, Msg_CompleteMatch)
 {
 	auto match = diff::diff_msg({
@@ -321,6 +1118,168 @@ TEST(DIFF, Msg_MoreSimilar)
 }
 
 
+TEST(DIFF, Msg_StreamHunks)
+{
+	types::StringsT expect = {
+		"advise",
+		"apathetic",
+		"disappear",
+		"greasy",
+		"toy",
+		"obtain",
+		"nosy",
+		"juicy",
+		"bright",
+		"jam",
+		"dust",
+		"silent",
+	};
+	types::StringsT got = {
+		"mate",
+		"head",
+		"greasy",
+		"toy",
+		"obtain",
+		"nosy",
+		"juicy",
+		"bright",
+		"jam",
+		"tremble",
+		"bed",
+		"hop",
+	};
+	const char* expect_hunks =
+		"@@ -1,6 +1,5 @@\n"
+		"- 0\t \tadvise\n"
+		"- 1\t \tapathetic\n"
+		"- 2\t \tdisappear\n"
+		"+  \t0\tmate\n"
+		"+  \t1\thead\n"
+		"  3\t2\tgreasy\n"
+		"  4\t3\ttoy\n"
+		"  5\t4\tobtain\n"
+		"@@ -8,5 +7,6 @@\n"
+		"  7\t6\tjuicy\n"
+		"  8\t7\tbright\n"
+		"  9\t8\tjam\n"
+		"- 10\t \tdust\n"
+		"- 11\t \tsilent\n"
+		"+  \t9\ttremble\n"
+		"+  \t10\tbed\n"
+		"+  \t11\thop\n";
+
+	std::stringstream out;
+	diff::write_diff_msg(out, expect, got);
+	EXPECT_STREQ(expect_hunks, out.str().c_str());
+
+	types::StringsT lines;
+	diff::write_diff_msg(
+		[&lines](const std::string& line)
+		{
+			lines.push_back(line);
+		}, expect, got, 5);
+	ASSERT_EQ(18, lines.size());
+	EXPECT_STREQ(expect_hunks, fmts::join("", lines.begin(), lines.end()).c_str());
+
+	// diffs written directly may be released before the writer finishes
+	std::stringstream direct;
+	diff::DiffWriter<std::string> writer(direct, true);
+	writer.write(diff::myers_diff(expect, got), expect, got);
+	writer.finish();
+	EXPECT_STREQ(expect_hunks, direct.str().c_str());
+
+	// empty ranges start at the line before them
+	std::stringstream appended;
+	diff::write_diff_msg(appended, {"a"}, {"a", "b"});
+	EXPECT_STREQ(
+		"@@ -1,1 +1,2 @@\n"
+		"  0\t0\ta\n"
+		"+  \t1\tb\n", appended.str().c_str());
+
+	std::stringstream created;
+	diff::write_diff_msg(created, {}, {"x"});
+	EXPECT_STREQ(
+		"@@ -0,0 +1,1 @@\n"
+		"+  \t0\tx\n", created.str().c_str());
+
+	std::stringstream same;
+	diff::write_diff_msg(same, expect, expect);
+	EXPECT_STREQ("", same.str().c_str());
+}
+
+
+TEST(DIFF, Msg_RefineLines)
+{
+	std::string orig_line;
+	std::string updated_line;
+	EXPECT_TRUE(diff::refine_line_pair(orig_line, updated_line,
+		"hello world", "jello word", 3));
+	EXPECT_STREQ("[-h-]ello wor[-l-]d", orig_line.c_str());
+	EXPECT_STREQ("{+j+}ello word", updated_line.c_str());
+	EXPECT_FALSE(diff::refine_line_pair(orig_line, updated_line,
+		"hello world", "jello word", 2));
+
+	types::StringsT expect = {
+		"a",
+		"int x = 1;",
+		"float y = 2.5;",
+		"b",
+		"c",
+		"d",
+		"e",
+		"f",
+		"g",
+		"h",
+		"totally different",
+	};
+	types::StringsT got = {
+		"a",
+		"int x = 2;",
+		"b",
+		"c",
+		"d",
+		"e",
+		"f",
+		"g",
+		"h",
+		"nothing alike",
+	};
+	EXPECT_STREQ(
+		"  0\t0\ta\n"
+		"- 1\t \tint x = [-1-];\n"
+		"- 2\t \tfloat y = 2.5;\n"
+		"+  \t1\tint x = {+2+};\n"
+		"  3\t2\tb\n"
+		"  4\t3\tc\n"
+		"  5\t4\td\n"
+		"  7\t6\tf\n"
+		"  8\t7\tg\n"
+		"  9\t8\th\n"
+		"- 10\t \ttotally different\n"
+		"+  \t9\tnothing alike\n",
+		diff::diff_msg(expect, got, diff::MYERS, 4).c_str());
+
+	std::stringstream out;
+	diff::write_diff_msg(out, expect, got,
+		std::numeric_limits<diff::IndexT>::max(), diff::MYERS, 4);
+	EXPECT_STREQ(
+		"@@ -1,6 +1,5 @@\n"
+		"  0\t0\ta\n"
+		"- 1\t \tint x = [-1-];\n"
+		"- 2\t \tfloat y = 2.5;\n"
+		"+  \t1\tint x = {+2+};\n"
+		"  3\t2\tb\n"
+		"  4\t3\tc\n"
+		"  5\t4\td\n"
+		"@@ -8,4 +7,4 @@\n"
+		"  7\t6\tf\n"
+		"  8\t7\tg\n"
+		"  9\t8\th\n"
+		"- 10\t \ttotally different\n"
+		"+  \t9\tnothing alike\n", out.str().c_str());
+}
+
+
 TEST(DIFF, Msg_CompleteDiff)
 {
 	auto no_overlap = diff::diff_msg({
@@ -758,6 +1717,98 @@ TEST(DIFF, SafeMsg_CompleteDiff)
 }
 
 
+TEST(DIFF, ParallelMsg)
+{
+	types::StringsT expect;
+	types::StringsT got;
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		std::string line = "line " + std::to_string(i);
+		if (i % 997 == 0)
+		{
+			got.push_back("changed " + line);
+		}
+		else if (i % 1499 == 0)
+		{
+			continue;
+		}
+		else
+		{
+			got.push_back(line);
+		}
+		if (i % 1201 != 0)
+		{
+			expect.push_back(line);
+		}
+		// repeated lines are never anchors
+		expect.push_back("}");
+		got.push_back("}");
+	}
+
+	for (diff::Algorithm algo : {diff::MYERS, diff::PATIENCE, diff::HISTOGRAM})
+	{
+		std::string expect_msg = diff::diff_msg(expect, got, algo);
+		EXPECT_LT(0, expect_msg.size());
+		for (size_t nthreads : {1, 3, 8})
+		{
+			EXPECT_STREQ(expect_msg.c_str(), diff::parallel_diff_msg(
+				expect, got, nthreads, algo).c_str()) <<
+				"algo=" << algo << " nthreads=" << nthreads;
+		}
+	}
+
+	EXPECT_STREQ("", diff::parallel_diff_msg(expect, expect).c_str());
+	EXPECT_STREQ("", diff::parallel_diff_msg({}, {}).c_str());
+	EXPECT_STREQ(diff::diff_msg({"a", "b", "c"}, {"c", "b"}).c_str(),
+		diff::parallel_diff_msg({"a", "b", "c"}, {"c", "b"}, 4).c_str());
+}
+
+
+/// Compares the time diff_msg and parallel_diff_msg with 1 to 16 threads
+/// take to diff 100000 lines with scattered changes
+/// Run with --gtest_also_run_disabled_tests
+TEST(DIFF, DISABLED_ParallelMsgThroughput)
+{
+	const size_t nlines = 50000;
+	types::StringsT expect;
+	types::StringsT got;
+	for (size_t i = 0; i < nlines; ++i)
+	{
+		std::string line = "line " + std::to_string(i);
+		if (i % 997 == 0)
+		{
+			got.push_back("changed " + line);
+		}
+		else if (i % 1499 != 0)
+		{
+			got.push_back(line);
+		}
+		if (i % 1201 != 0)
+		{
+			expect.push_back(line);
+		}
+		expect.push_back("}");
+		got.push_back("}");
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::string serial_msg = diff::diff_msg(expect, got);
+	double serial_secs = elapsed_since(start);
+	EXPECT_LT(0, serial_msg.size());
+	std::cout << "diff_msg: " << serial_secs << " s" << std::endl;
+
+	for (size_t nthreads = 1; nthreads <= 16; nthreads <<= 1)
+	{
+		start = std::chrono::steady_clock::now();
+		std::string msg = diff::parallel_diff_msg(expect, got, nthreads);
+		double secs = elapsed_since(start);
+		EXPECT_LT(0, msg.size());
+		std::cout << "parallel_diff_msg(" << nthreads << "): " << secs <<
+			" s (" << serial_secs / secs << "x)" << std::endl;
+	}
+}
+
+
 TEST(DIFF, DiffLines)
 {
 	std::stringstream left;
@@ -865,4 +1916,60 @@ TEST(DIFF, DiffLines)
 }
 
 
+TEST(DIFF, DiffFiles)
+{
+	std::string left =
+		" advise  \n"
+		"  apathetic\n\n"
+		" disappear   \n"
+		"greasy \n"
+		"\ttoy\n"
+		"nosy\n"
+		"juicy\t\n"
+		"silent\n";
+	std::string right =
+		"advise\n"
+		"  apathetic\n"
+		" disappear   \n"
+		"\ttoy\n"
+		"nosy\n\n"
+		"  dust\n"
+		"silent";
+	std::string left_path = ::testing::TempDir() + "diff_files_left.txt";
+	std::string right_path = ::testing::TempDir() + "diff_files_right.txt";
+	std::string empty_path = ::testing::TempDir() + "diff_files_empty.txt";
+	std::ofstream(left_path) << left;
+	std::ofstream(right_path) << right;
+	std::ofstream(empty_path).close();
+
+	for (bool ignore_empty : {false, true})
+	{
+		for (bool trim : {false, true})
+		{
+			std::stringstream lstr(left);
+			std::stringstream rstr(right);
+			std::string expect = diff::diff_lines(lstr, rstr,
+				ignore_empty, trim);
+			diff::DiffOptions opts;
+			opts.ignore_empty_lines_ = ignore_empty;
+			opts.trim_spaces_ = trim;
+			EXPECT_STREQ(expect.c_str(), diff::diff_files(
+				left_path, right_path, opts).c_str()) <<
+				"ignore_empty=" << ignore_empty << " trim=" << trim;
+		}
+	}
+
+	EXPECT_STREQ("", diff::diff_files(left_path, left_path).c_str());
+	std::ofstream(right_path) << "\tx  \n";
+	EXPECT_STREQ("+  \t0\tx\n",
+		diff::diff_files(empty_path, right_path).c_str());
+	EXPECT_THROW(diff::diff_files(left_path,
+		::testing::TempDir() + "diff_files_missing.txt"), std::runtime_error);
+
+	std::remove(left_path.c_str());
+	std::remove(right_path.c_str());
+	std::remove(empty_path.c_str());
+}
+
+
 #endif // DISABLE_DIFF_TEST
@@ -30,8 +30,8 @@ struct AsyncClientHandler final : public iClientHandler
 	{
 		if (status_.ok())
 		{
-			logger_->log(logs::info_level, fmts::sprintf(
-				"call %p completed successfully", this));
+			LOGS_LOGGER_LOGF(*logger_, INFO,
+				"call %p completed successfully", this);
 			if (cb_)
 			{
 				cb_(reply_);
@@ -41,9 +41,9 @@ struct AsyncClientHandler final : public iClientHandler
 		{
 			if (nretries_ > 0)
 			{
-				logger_->log(logs::error_level, fmts::sprintf(
+				LOGS_LOGGER_LOGF(*logger_, ERROR,
 					"call %p (%d attempts remaining) failed: %s",
-					this, nretries_, status_.error_message().c_str()));
+					this, nretries_, status_.error_message().c_str());
 				new AsyncClientHandler<REQ,RES>(
 					complete_promise_, logger_, cb_, init_, nretries_ - 1);
 				complete_promise_ = nullptr;
@@ -51,9 +51,9 @@ struct AsyncClientHandler final : public iClientHandler
 			else
 			{
 				error_ = error::error(status_.error_message());
-				logger_->log(logs::error_level, fmts::sprintf(
+				LOGS_LOGGER_LOGF(*logger_, ERROR,
 					"call %p failed: %s",
-					this, status_.error_message().c_str()));
+					this, status_.error_message().c_str());
 			}
 		}
 		delete this;
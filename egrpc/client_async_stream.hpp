@@ -28,15 +28,15 @@ struct AsyncClientStreamHandler final : public iClientHandler
 		case STARTUP:
 			if (event_status)
 			{
-				logger_->log(logs::info_level, fmts::sprintf(
-					"call %p created... processing", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO,
+					"call %p created... processing", this);
 				call_status_ = PROCESS;
 				reader_->Read(&reply_, (void*) this);
 			}
 			else
 			{
-				logger_->log(logs::info_level, fmts::sprintf(
-					"call %p created... finishing", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO,
+					"call %p created... finishing", this);
 				call_status_ = FINISH;
 				reader_->Finish(&status_, (void*)this);
 			}
@@ -44,15 +44,15 @@ struct AsyncClientStreamHandler final : public iClientHandler
 		case PROCESS:
 			if (event_status)
 			{
-				logger_->log(logs::info_level, fmts::sprintf(
-					"call %p received... handling", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO,
+					"call %p received... handling", this);
 				handler_(reply_);
 				reader_->Read(&reply_, (void*)this);
 			}
 			else
 			{
-				logger_->log(logs::info_level, fmts::sprintf(
-					"call %p received... finishing", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO,
+					"call %p received... finishing", this);
 				call_status_ = FINISH;
 				reader_->Finish(&status_, (void*)this);
 			}
@@ -60,15 +60,15 @@ struct AsyncClientStreamHandler final : public iClientHandler
 		case FINISH:
 			if (status_.ok())
 			{
-				logger_->log(logs::info_level, fmts::sprintf(
-					"call %p completed successfully", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO,
+					"call %p completed successfully", this);
 			}
 			else
 			{
 				error_ = error::error(status_.error_message());
-				logger_->log(logs::error_level, fmts::sprintf(
+				LOGS_LOGGER_LOGF(*logger_, ERROR,
 					"call %p failed: %s",
-					this, status_.error_message().c_str()));
+					this, status_.error_message().c_str());
 			}
 			delete this;
 		}
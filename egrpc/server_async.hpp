@@ -47,20 +47,20 @@ struct AsyncServerCall final : public iServerCall
 		req_call_(req_call), write_call_(write_call)
 	{
 		req_call_(&ctx_, &req_, *responder_, *cq_, (void*) this);
-		logger_->log(logs::info_level, fmts::sprintf("rpc %p created", this));
+		LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p created", this);
 	}
 
 	void serve (void) override
 	{
 		if (done_)
 		{
-			logger_->log(logs::info_level, fmts::sprintf("rpc %p completed", this));
+			LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p completed", this);
 			shutdown();
 		}
 		else
 		{
 			new AsyncServerCall(logger_, req_call_, write_call_, *cq_, responder_builder_);
-			logger_->log(logs::info_level, fmts::sprintf("rpc %p writing", this));
+			LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p writing", this);
 			RES reply;
 			done_ = true;
 			auto status = write_call_(req_, reply);
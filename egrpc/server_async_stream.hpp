@@ -52,7 +52,7 @@ struct AsyncServerStreamCall final : public iServerCall
 	{
 		assert(nullptr != writer_);
 		req_call_(&ctx_, &req_, *writer_, *cq_, (void*) this);
-		logger_->log(logs::info_level, fmts::sprintf("rpc %p created", this));
+		LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p created", this);
 	}
 
 	void serve (void) override
@@ -63,7 +63,7 @@ struct AsyncServerStreamCall final : public iServerCall
 		{
 			new AsyncServerStreamCall(
 				logger_, req_call_, init_call_, write_call_, *cq_, writer_builder_);
-			logger_->log(logs::info_level, fmts::sprintf("rpc %p initializing", this));
+			LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p initializing", this);
 			auto out_status = init_call_(ranges_, req_);
 			if (false == out_status.ok())
 			{
@@ -80,7 +80,7 @@ struct AsyncServerStreamCall final : public iServerCall
 			if (it_ != ranges_.end())
 			{
 				RES reply;
-				logger_->log(logs::info_level, fmts::sprintf("rpc %p writing", this));
+				LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p writing", this);
 				bool wrote = false;
 				while (false == wrote && it_ != ranges_.end())
 				{
@@ -102,7 +102,7 @@ struct AsyncServerStreamCall final : public iServerCall
 		}
 			break;
 		case FINISH:
-			logger_->log(logs::info_level, fmts::sprintf("rpc %p completed", this));
+			LOGS_LOGGER_LOGF(*logger_, INFO, "rpc %p completed", this);
 			shutdown();
 		}
 	}
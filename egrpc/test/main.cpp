@@ -60,7 +60,7 @@ TEST(ASYNC, ClientRequestSuccess)
 	}, 3);
 
 	auto expect_msg = fmts::sprintf("call %p completed successfully", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg, _)).Times(1);
 
 	EXPECT_FALSE(cb_called);
 
@@ -86,7 +86,7 @@ TEST(ASYNC, ClientRequestFail)
 
 	std::string firstmsg;
 	std::string lastmsg;
-	EXPECT_CALL(*logger, log(logs::error_level, _, _)).Times(nretries + 1).
+	EXPECT_CALL(*logger, log(logs::ERROR, _, _)).Times(nretries + 1).
 		WillOnce(SaveArg<1>(&firstmsg)).
 		WillOnce(Return()).
 		WillOnce(Return()).
@@ -196,7 +196,7 @@ TEST(ASYNC, ClientStreamSuccess)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg1 = fmts::sprintf("call %p created... processing", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg1, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg1, _)).Times(1);
 
 	void* got_tag;
 	bool ok = true;
@@ -207,7 +207,7 @@ TEST(ASYNC, ClientStreamSuccess)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg2 = fmts::sprintf("call %p received... handling", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg2, _)).Times(2);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg2, _)).Times(2);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_TRUE(ok);
@@ -222,7 +222,7 @@ TEST(ASYNC, ClientStreamSuccess)
 	EXPECT_EQ(2, num_cb_called);
 
 	auto expect_msg3 = fmts::sprintf("call %p received... finishing", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg3, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg3, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_FALSE(ok);
@@ -231,7 +231,7 @@ TEST(ASYNC, ClientStreamSuccess)
 	EXPECT_EQ(2, num_cb_called);
 
 	auto expect_msg4 = fmts::sprintf("call %p completed successfully", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg4, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg4, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_TRUE(ok);
@@ -284,7 +284,7 @@ TEST(ASYNC, ClientStreamEarlyStop)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg = fmts::sprintf("call %p created... finishing", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg, _)).Times(1);
 
 	void* got_tag;
 	bool ok = true;
@@ -295,7 +295,7 @@ TEST(ASYNC, ClientStreamEarlyStop)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg2 = fmts::sprintf("call %p completed successfully", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg2, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg2, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_TRUE(ok);
@@ -348,7 +348,7 @@ TEST(ASYNC, ClientStreamFail)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg = fmts::sprintf("call %p created... processing", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg, _)).Times(1);
 
 	void* got_tag;
 	bool ok = true;
@@ -360,7 +360,7 @@ TEST(ASYNC, ClientStreamFail)
 	EXPECT_EQ(0, num_cb_called);
 
 	auto expect_msg2 = fmts::sprintf("call %p received... handling", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg2, _)).Times(2);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg2, _)).Times(2);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_TRUE(ok);
@@ -375,7 +375,7 @@ TEST(ASYNC, ClientStreamFail)
 	EXPECT_EQ(2, num_cb_called);
 
 	auto expect_msg3 = fmts::sprintf("call %p received... finishing", ptr);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg3, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg3, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_FALSE(ok);
@@ -384,7 +384,7 @@ TEST(ASYNC, ClientStreamFail)
 	EXPECT_EQ(2, num_cb_called);
 
 	auto expect_msg4 = fmts::sprintf("call %p failed: oh no", ptr);
-	EXPECT_CALL(*logger, log(logs::error_level, expect_msg4, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::ERROR, expect_msg4, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&got_tag, &ok));
 	EXPECT_TRUE(ok);
@@ -453,7 +453,7 @@ TEST(ASYNC, ServerRequest)
 
 	std::string msg;
 	std::string msg2;
-	EXPECT_CALL(*logger, log(logs::info_level, _, _)).Times(3).
+	EXPECT_CALL(*logger, log(logs::INFO, _, _)).Times(3).
 		WillOnce(SaveArg<1>(&msg)).
 		WillOnce(Return()). // ignore creation message for next handler
 		WillOnce(SaveArg<1>(&msg2));
@@ -520,7 +520,7 @@ TEST(ASYNC, ServerRequest)
 	EXPECT_STREQ(expect_msg2.c_str(), msg2.c_str());
 
 	auto expect_msg3 = fmts::sprintf("rpc %p completed", call);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg3, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg3, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&tag, &ok));
 	EXPECT_TRUE(ok);
@@ -557,7 +557,7 @@ TEST(ASYNC, ServerRequestFailed)
 
 	std::string msg;
 	std::string msg1;
-	EXPECT_CALL(*logger, log(logs::info_level, _, _)).Times(3).
+	EXPECT_CALL(*logger, log(logs::INFO, _, _)).Times(3).
 		WillOnce(SaveArg<1>(&msg)).
 		WillOnce(Return()). // ignore creation message for next handler
 		WillOnce(SaveArg<1>(&msg1));
@@ -624,7 +624,7 @@ TEST(ASYNC, ServerRequestFailed)
 	EXPECT_TRUE(serve_call);
 
 	auto expect_msg2 = fmts::sprintf("rpc %p completed", call);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg2, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg2, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&tag, &ok));
 	EXPECT_TRUE(ok);
@@ -664,7 +664,7 @@ TEST(ASYNC, ServerStream)
 	std::string msg2;
 	std::string msg3;
 	std::string msg4;
-	EXPECT_CALL(*logger, log(logs::info_level, _, _)).Times(6).
+	EXPECT_CALL(*logger, log(logs::INFO, _, _)).Times(6).
 		WillOnce(SaveArg<1>(&msg)).
 		WillOnce(Return()). // ignore creation message for next handler
 		WillOnce(SaveArg<1>(&msg1)).
@@ -766,7 +766,7 @@ TEST(ASYNC, ServerStream)
 
 	EXPECT_EQ(2, num_calls);
 	EXPECT_EQ(3, num_iterators);
-	EXPECT_CALL(*logger, log(logs::info_level, expect_msg, _)).Times(1);
+	EXPECT_CALL(*logger, log(logs::INFO, expect_msg, _)).Times(1);
 
 	EXPECT_TRUE(cq.next(&tag, &ok));
 	EXPECT_TRUE(ok);
@@ -815,7 +815,7 @@ TEST(ASYNC, ServerStreamStartupError)
 	std::string msg;
 	std::string msg1;
 	std::string msg2;
-	EXPECT_CALL(*logger, log(logs::info_level, _, _)).Times(4).
+	EXPECT_CALL(*logger, log(logs::INFO, _, _)).Times(4).
 		WillOnce(SaveArg<1>(&msg)).
 		WillOnce(Return()). // ignore creation message for next handler
 		WillOnce(SaveArg<1>(&msg1)).
@@ -940,7 +940,7 @@ TEST(ASYNC, ServerStreamForcedFinish)
 	std::string msg1;
 	std::string msg2;
 	std::string creation_msg;
-	EXPECT_CALL(*logger, log(logs::info_level, _, _)).Times(4).
+	EXPECT_CALL(*logger, log(logs::INFO, _, _)).Times(4).
 		WillOnce(SaveArg<1>(&msg)).
 		WillOnce(SaveArg<1>(&creation_msg)). // ignore creation message for next handler
 		WillOnce(SaveArg<1>(&msg1)).
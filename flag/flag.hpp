@@ -56,6 +56,11 @@ struct FlagSet
 		pos_.add(name, maxcount);
 	}
 
+	/// Add --log_modules flag whose value (e.g.: "info,egrpc=debug") sets
+	/// log levels per module using logs::set_module_levels once parsed
+	/// Values rejected by logs::set_module_levels fail the parse
+	void add_log_modules_flag (void);
+
 private:
 	/// Flag options
 	opt::options_description flags_;
@@ -9,6 +9,8 @@ namespace flag
 
 namespace fs = boost::filesystem;
 
+static const char* log_modules_flag = "log_modules";
+
 static std::string make_usage_string (const std::string& program_name,
 	const opt::options_description& flag_desc,
 	opt::positional_options_description& pos)
@@ -48,6 +50,23 @@ FlagSet::FlagSet (const char* prog) :
 	flags_(fmts::sprintf("%s flags", prog)),
 	args_(fmts::sprintf("%s arguments", prog)) {}
 
+void FlagSet::add_log_modules_flag (void)
+{
+	flags_.add_options()
+		(log_modules_flag, opt::value<std::string>()->notifier(
+			[](const std::string& spec)
+			{
+				if (false == logs::set_module_levels(spec))
+				{
+					throw opt::error(fmts::sprintf(
+						"invalid log levels for option '--%s': %s",
+						log_modules_flag, spec.c_str()));
+				}
+			}),
+			"Comma-separated log levels per module "
+			"(e.g.: info,egrpc=debug)");
+}
+
 bool FlagSet::parse(int argc, const char** argv, opt::variables_map& vars)
 {
 	flags_.add_options()
@@ -229,4 +229,28 @@ TEST_F(FLAG, Parse)
 }
 
 
+TEST_F(FLAG, LogModules)
+{
+	flag::FlagSet f(program);
+	f.add_log_modules_flag();
+
+	logs::set_log_level("trace");
+	static logs::LogSite site(logs::DEBUG, "flagged");
+	EXPECT_TRUE(site.enabled());
+
+	const char* args[] = {program, "--log_modules", "flagged=info"};
+	ASSERT_TRUE(f.parse(3, args));
+	EXPECT_FALSE(site.enabled());
+
+	const char* badargs[] = {program, "--log_modules", "flagged=loud"};
+	ASSERT_FALSE(f.parse(3, badargs));
+	EXPECT_STREQ("invalid log levels for option '--log_modules': "
+		"flagged=loud", TestLogger::latest_error_.c_str());
+	EXPECT_FALSE(site.enabled());
+
+	logs::set_module_levels("");
+	EXPECT_TRUE(site.enabled());
+}
+
+
 #endif // DISABLE_FLAG_TEST
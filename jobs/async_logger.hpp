@@ -0,0 +1,222 @@
+///
+/// async_logger.hpp
+/// jobs
+///
+/// Purpose:
+/// Define logger that hands messages to another logger on a background job
+///
+
+#ifndef PKG_JOBS_ASYNC_LOGGER_HPP
+#define PKG_JOBS_ASYNC_LOGGER_HPP
+
+#include <mutex>
+
+#include "logs/logs.hpp"
+
+#include "jobs/managed_job.hpp"
+#include "jobs/mpsc_ring.hpp"
+
+namespace jobs
+{
+
+/// Default number of messages AsyncLogger holds before overflowing
+const size_t async_log_capacity = 1 << 14;
+
+/// Encoding of what AsyncLogger does with messages logged while full
+enum OverflowPolicy
+{
+	/// Caller waits until there is room
+	BLOCK_WHEN_FULL = 0,
+	/// Message is dropped and counted
+	DROP_WHEN_FULL,
+	/// Message is dropped and counted, and the number of dropped messages
+	/// is logged as a warning once there is room
+	REPORT_WHEN_FULL,
+};
+
+/// Logger that enqueues messages without locking, and logs them to
+/// a sink logger from a background job, so callers never wait on the sink
+/// Fatal messages are logged synchronously after every enqueued message,
+/// so exceptions thrown by the sink reach the caller
+struct AsyncLogger final : public logs::iLogger
+{
+	AsyncLogger (std::shared_ptr<logs::iLogger> sink =
+			std::make_shared<logs::DefLogger>(),
+		size_t capacity = async_log_capacity,
+		OverflowPolicy policy = BLOCK_WHEN_FULL) :
+		sink_(sink), policy_(policy), records_(capacity),
+		log_level_(logs::enum_log(sink->get_log_level())),
+		drainer_([this]{ drain(); }) {}
+
+	~AsyncLogger (void)
+	{
+		drainer_.stop();
+		drainer_.join();
+		drain();
+	}
+
+	AsyncLogger (const AsyncLogger& other) = delete;
+
+	AsyncLogger& operator = (const AsyncLogger& other) = delete;
+
+	/// Implementation of iLogger
+	std::string get_log_level (void) const override
+	{
+		size_t level = log_level_.load(std::memory_order_relaxed);
+		if (level < logs::NOT_SET)
+		{
+			return logs::name_log((logs::LOG_LEVEL) level);
+		}
+		// sink's level is not a LOG_LEVEL name, so it is not cached
+		std::lock_guard<std::mutex> guard(drain_mtx_);
+		return sink_->get_log_level();
+	}
+
+	/// Implementation of iLogger
+	void set_log_level (const std::string& log_level) override
+	{
+		{
+			std::lock_guard<std::mutex> guard(drain_mtx_);
+			sink_->set_log_level(log_level);
+			log_level_ = logs::enum_log(sink_->get_log_level());
+		}
+		// sync_log_level reads get_log_level, so drain_mtx_ must be free
+		logs::sync_log_level(*this);
+	}
+
+	/// Implementation of iLogger
+	bool syncs_log_level (void) const override
+	{
+		return true;
+	}
+
+	/// Implementation of iLogger
+	bool supports_level (size_t msg_level) const override
+	{
+		return sink_->supports_level(msg_level);
+	}
+
+	/// Implementation of iLogger
+	bool supports_level (const std::string& msg_level) const override
+	{
+		return sink_->supports_level(msg_level);
+	}
+
+	/// Implementation of iLogger
+	void log (const std::string& msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		logs::LOG_LEVEL level = logs::TRACE;
+		auto it = logs::names2log.find(msg_level);
+		if (logs::names2log.end() != it)
+		{
+			level = it->second;
+		}
+		log(level, msg, location);
+	}
+
+	/// Implementation of iLogger
+	void log (size_t msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		if (msg_level <= log_level_.load(std::memory_order_relaxed))
+		{
+			log_unfiltered(msg_level, msg, location);
+		}
+	}
+
+	/// Implementation of iLogger
+	void log_unfiltered (size_t msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		if (msg_level == logs::FATAL)
+		{
+			std::lock_guard<std::mutex> guard(drain_mtx_);
+			drain_locked();
+			sink_->log_unfiltered(msg_level, msg, location);
+			return;
+		}
+		Record record{msg_level, msg, location};
+		while (false == records_.try_push(std::move(record)))
+		{
+			if (policy_ != BLOCK_WHEN_FULL)
+			{
+				ndropped_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	/// Log every enqueued message to the sink
+	void flush (void)
+	{
+		std::lock_guard<std::mutex> guard(drain_mtx_);
+		drain_locked();
+	}
+
+	/// Return the number of messages dropped while full
+	size_t get_dropped (void) const
+	{
+		return ndropped_.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Record final
+	{
+		size_t level_;
+
+		std::string msg_;
+
+		logs::SrcLocT location_;
+	};
+
+	void drain (void)
+	{
+		std::lock_guard<std::mutex> guard(drain_mtx_);
+		drain_locked();
+	}
+
+	void drain_locked (void)
+	{
+		Record record;
+		while (records_.try_pop(record))
+		{
+			sink_->log_unfiltered(record.level_, record.msg_, record.location_);
+		}
+		if (policy_ == REPORT_WHEN_FULL)
+		{
+			size_t ndropped = ndropped_.load(std::memory_order_relaxed);
+			if (ndropped > nreported_)
+			{
+				sink_->log(logs::WARN, fmts::sprintf(
+					"dropped %zu log messages", ndropped - nreported_));
+				nreported_ = ndropped;
+			}
+		}
+	}
+
+	std::shared_ptr<logs::iLogger> sink_;
+
+	OverflowPolicy policy_;
+
+	MpscRing<Record> records_;
+
+	/// Messages above this level are not enqueued
+	std::atomic<size_t> log_level_;
+
+	std::atomic<size_t> ndropped_ = 0;
+
+	/// Number of dropped messages reported to sink (guarded by drain_mtx_)
+	size_t nreported_ = 0;
+
+	/// Serializes consumers of records_ and calls to sink_
+	mutable std::mutex drain_mtx_;
+
+	/// Declared last, so it stops before the members it drains are destroyed
+	ManagedJob drainer_;
+};
+
+}
+
+#endif // PKG_JOBS_ASYNC_LOGGER_HPP
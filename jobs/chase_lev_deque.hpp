@@ -0,0 +1,168 @@
+///
+/// chase_lev_deque.hpp
+/// jobs
+///
+/// Purpose:
+/// Define lock-free deque where one thread works at the bottom
+/// and other threads steal from the top
+///
+
+#ifndef PKG_JOBS_CHASE_LEV_DEQUE_HPP
+#define PKG_JOBS_CHASE_LEV_DEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "jobs/mpsc_ring.hpp"
+
+namespace jobs
+{
+
+/// Default number of values ChaseLevDeque holds before growing
+const size_t deque_capacity = 64;
+
+/// Unbounded work-stealing deque (Chase and Lev) of trivially copyable
+/// values, where the owning thread pushes and pops at the bottom without
+/// contention and any thread steals the oldest value from the top
+/// Arrays replaced while growing are kept until destruction,
+/// since thieves may still be reading them
+template <typename T>
+struct ChaseLevDeque final
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"deque values must be trivially copyable (e.g.: pointers)");
+
+	/// Capacity is rounded up to a power of 2
+	ChaseLevDeque (size_t capacity = deque_capacity)
+	{
+		size_t n = 1;
+		for (; n < capacity; n <<= 1);
+		arrays_.push_back(std::make_unique<Array>(n));
+		array_.store(arrays_.back().get(), std::memory_order_relaxed);
+	}
+
+	ChaseLevDeque (const ChaseLevDeque<T>& other) = delete;
+
+	ChaseLevDeque<T>& operator = (const ChaseLevDeque<T>& other) = delete;
+
+	/// Add val at the bottom, growing if full
+	/// Only the owning thread pushes and pops
+	void push (T val)
+	{
+		int64_t b = bottom_.load(std::memory_order_relaxed);
+		int64_t t = top_.load(std::memory_order_acquire);
+		Array* array = array_.load(std::memory_order_relaxed);
+		if (b - t > static_cast<int64_t>(array->mask_))
+		{
+			array = grow(array, t, b);
+		}
+		array->at(b).store(val, std::memory_order_relaxed);
+		bottom_.store(b + 1, std::memory_order_release);
+	}
+
+	/// Return true and set out to the newest value if any,
+	/// otherwise return false
+	/// Only the owning thread pushes and pops
+	bool pop (T& out)
+	{
+		int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+		Array* array = array_.load(std::memory_order_relaxed);
+		// reserve the bottom before reading top, so a thief reading
+		// bottom after this store cannot take the same value unseen
+		bottom_.store(b, std::memory_order_seq_cst);
+		int64_t t = top_.load(std::memory_order_seq_cst);
+		if (t > b)
+		{
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		out = array->at(b).load(std::memory_order_relaxed);
+		if (t < b)
+		{
+			return true;
+		}
+		// last value, race thieves for it
+		bool won = top_.compare_exchange_strong(t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom_.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	/// Return true and set out to the oldest value if any and no other
+	/// thread took it first, otherwise return false
+	/// Any thread may steal
+	bool steal (T& out)
+	{
+		int64_t t = top_.load(std::memory_order_seq_cst);
+		int64_t b = bottom_.load(std::memory_order_seq_cst);
+		if (t >= b)
+		{
+			return false;
+		}
+		Array* array = array_.load(std::memory_order_acquire);
+		T val = array->at(t).load(std::memory_order_relaxed);
+		if (false == top_.compare_exchange_strong(t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		out = val;
+		return true;
+	}
+
+	/// Return the number of values, which may be stale by the time
+	/// it is read if other threads use the deque
+	size_t size (void) const
+	{
+		int64_t b = bottom_.load(std::memory_order_relaxed);
+		int64_t t = top_.load(std::memory_order_relaxed);
+		return b > t ? b - t : 0;
+	}
+
+private:
+	struct Array final
+	{
+		Array (size_t n) : mask_(n - 1),
+			slots_(std::make_unique<std::atomic<T>[]>(n)) {}
+
+		std::atomic<T>& at (int64_t i)
+		{
+			return slots_[i & mask_];
+		}
+
+		size_t mask_;
+
+		std::unique_ptr<std::atomic<T>[]> slots_;
+	};
+
+	/// Return array twice the size of array holding its values from t to b
+	Array* grow (Array* array, int64_t t, int64_t b)
+	{
+		auto bigger = std::make_unique<Array>((array->mask_ + 1) << 1);
+		for (int64_t i = t; i < b; ++i)
+		{
+			bigger->at(i).store(array->at(i).load(
+				std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		Array* out = bigger.get();
+		arrays_.push_back(std::move(bigger));
+		array_.store(out, std::memory_order_release);
+		return out;
+	}
+
+	alignas(cache_line_size) std::atomic<int64_t> top_ = 0;
+
+	alignas(cache_line_size) std::atomic<int64_t> bottom_ = 0;
+
+	std::atomic<Array*> array_;
+
+	/// Every array used so far (only accessed by the owning thread)
+	std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+}
+
+#endif // PKG_JOBS_CHASE_LEV_DEQUE_HPP
@@ -1,4 +1,8 @@
 
+#include "jobs/async_logger.hpp"
+#include "jobs/chase_lev_deque.hpp"
 #include "jobs/managed_job.hpp"
+#include "jobs/mpsc_ring.hpp"
 #include "jobs/scope_guard.hpp"
 #include "jobs/sequence.hpp"
+#include "jobs/thread_pool.hpp"
@@ -0,0 +1,124 @@
+///
+/// mpsc_ring.hpp
+/// jobs
+///
+/// Purpose:
+/// Define bounded lock-free queue for many producers and one consumer
+///
+
+#ifndef PKG_JOBS_MPSC_RING_HPP
+#define PKG_JOBS_MPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace jobs
+{
+
+/// Assumed size of cache lines, used to keep producer and consumer
+/// counters from sharing lines
+const size_t cache_line_size = 64;
+
+/// Bounded ring buffer where any number of threads push without locks
+/// and a single thread at a time pops
+/// Each slot carries a sequence number telling producers and the consumer
+/// whether it is free or filled for the current lap around the ring
+template <typename T>
+struct MpscRing final
+{
+	/// Capacity is rounded up to a power of 2
+	MpscRing (size_t capacity)
+	{
+		size_t n = 1;
+		for (; n < capacity; n <<= 1);
+		mask_ = n - 1;
+		slots_ = std::make_unique<Slot[]>(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			slots_[i].seq_.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpscRing (const MpscRing<T>& other) = delete;
+
+	MpscRing<T>& operator = (const MpscRing<T>& other) = delete;
+
+	/// Return true and move val into the ring if there is room,
+	/// otherwise return false leaving val untouched
+	bool try_push (T&& val)
+	{
+		Slot* slot;
+		size_t pos = tail_.load(std::memory_order_relaxed);
+		while (true)
+		{
+			slot = &slots_[pos & mask_];
+			size_t seq = slot->seq_.load(std::memory_order_acquire);
+			intptr_t lag = static_cast<intptr_t>(seq) -
+				static_cast<intptr_t>(pos);
+			if (lag == 0)
+			{
+				if (tail_.compare_exchange_weak(pos, pos + 1,
+					std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (lag < 0)
+			{
+				// slot still holds the value from the previous lap
+				return false;
+			}
+			else
+			{
+				pos = tail_.load(std::memory_order_relaxed);
+			}
+		}
+		slot->val_ = std::move(val);
+		slot->seq_.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Return true and move the oldest value into out if any,
+	/// otherwise return false
+	/// Callers must not pop concurrently
+	bool try_pop (T& out)
+	{
+		Slot& slot = slots_[head_ & mask_];
+		if (slot.seq_.load(std::memory_order_acquire) != head_ + 1)
+		{
+			return false;
+		}
+		out = std::move(slot.val_);
+		slot.seq_.store(head_ + mask_ + 1, std::memory_order_release);
+		++head_;
+		return true;
+	}
+
+	/// Return the maximum number of values in the ring
+	size_t capacity (void) const
+	{
+		return mask_ + 1;
+	}
+
+private:
+	struct alignas(cache_line_size) Slot final
+	{
+		std::atomic<size_t> seq_;
+
+		T val_;
+	};
+
+	std::unique_ptr<Slot[]> slots_;
+
+	size_t mask_;
+
+	alignas(cache_line_size) std::atomic<size_t> tail_ = 0;
+
+	alignas(cache_line_size) size_t head_ = 0;
+};
+
+}
+
+#endif // PKG_JOBS_MPSC_RING_HPP
@@ -1,8 +1,12 @@
 #include "gtest/gtest.h"
 
+#include "jobs/async_logger.hpp"
+#include "jobs/chase_lev_deque.hpp"
 #include "jobs/managed_job.hpp"
+#include "jobs/mpsc_ring.hpp"
 #include "jobs/scope_guard.hpp"
 #include "jobs/sequence.hpp"
+#include "jobs/thread_pool.hpp"
 
 
 int main (int argc, char** argv)
@@ -195,4 +199,449 @@ TEST(JOBS, SequenceTermination)
 }
 
 
+TEST(JOBS, MpscRing)
+{
+	jobs::MpscRing<std::string> ring(5);
+	EXPECT_EQ(8, ring.capacity());
+	for (size_t i = 0; i < 8; ++i)
+	{
+		EXPECT_TRUE(ring.try_push(std::to_string(i)));
+	}
+	std::string full = "full";
+	EXPECT_FALSE(ring.try_push(std::move(full)));
+	EXPECT_STREQ("full", full.c_str());
+
+	std::string out;
+	for (size_t i = 0; i < 8; ++i)
+	{
+		ASSERT_TRUE(ring.try_pop(out));
+		EXPECT_STREQ(std::to_string(i).c_str(), out.c_str());
+		// slot is reusable on the next lap
+		EXPECT_TRUE(ring.try_push(std::to_string(i + 8)));
+	}
+	for (size_t i = 8; i < 16; ++i)
+	{
+		ASSERT_TRUE(ring.try_pop(out));
+		EXPECT_STREQ(std::to_string(i).c_str(), out.c_str());
+	}
+	EXPECT_FALSE(ring.try_pop(out));
+}
+
+
+struct CollectLogger final : public logs::iLogger
+{
+	std::string get_log_level (void) const override
+	{
+		return logs::trace_level;
+	}
+
+	void set_log_level (const std::string& log_level) override {}
+
+	bool supports_level (size_t msg_level) const override
+	{
+		return true;
+	}
+
+	bool supports_level (const std::string& msg_level) const override
+	{
+		return true;
+	}
+
+	void log (const std::string& msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		log(logs::enum_log(msg_level), msg, location);
+	}
+
+	void log (size_t msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		// held by tests to stall the async logger's drain
+		std::lock_guard<std::mutex> gate(gate_);
+		levels_.push_back(msg_level);
+		msgs_.push_back(msg);
+	}
+
+	std::mutex gate_;
+
+	std::vector<size_t> levels_;
+
+	types::StringsT msgs_;
+};
+
+
+TEST(JOBS, AsyncLoggerProducers)
+{
+	const size_t nproducers = 16;
+	const size_t nmsgs = 1000;
+	auto sink = std::make_shared<CollectLogger>();
+	{
+		jobs::AsyncLogger logger(sink, 64);
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < nproducers; ++i)
+		{
+			producers.push_back(std::thread(
+			[&logger, i]
+			{
+				for (size_t j = 0; j < nmsgs; ++j)
+				{
+					logger.log(logs::INFO, fmts::sprintf("%zu %zu", i, j));
+				}
+			}));
+		}
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+		EXPECT_EQ(0, logger.get_dropped());
+	}
+
+	// every message arrives, in order for each producer
+	ASSERT_EQ(nproducers * nmsgs, sink->msgs_.size());
+	std::vector<size_t> nexts(nproducers, 0);
+	for (const std::string& msg : sink->msgs_)
+	{
+		size_t producer, index;
+		ASSERT_EQ(2, std::sscanf(msg.c_str(), "%zu %zu", &producer, &index));
+		ASSERT_GT(nproducers, producer);
+		EXPECT_EQ(nexts[producer]++, index);
+	}
+}
+
+
+TEST(JOBS, AsyncLoggerOverflow)
+{
+	auto sink = std::make_shared<CollectLogger>();
+	jobs::AsyncLogger logger(sink, 4, jobs::REPORT_WHEN_FULL);
+	size_t naccepted;
+	{
+		// stall the drain, so the ring fills up
+		std::lock_guard<std::mutex> gate(sink->gate_);
+		for (size_t i = 0; i < 100; ++i)
+		{
+			logger.log(logs::WARN, std::to_string(i));
+		}
+		EXPECT_LT(90, logger.get_dropped());
+		naccepted = 100 - logger.get_dropped();
+	}
+	logger.flush();
+
+	std::lock_guard<std::mutex> gate(sink->gate_);
+	ASSERT_EQ(naccepted + 1, sink->msgs_.size());
+	EXPECT_STREQ(fmts::sprintf("dropped %zu log messages",
+		logger.get_dropped()).c_str(), sink->msgs_.back().c_str());
+}
+
+
+TEST(JOBS, AsyncLoggerFatal)
+{
+	auto sink = std::make_shared<CollectLogger>();
+	jobs::AsyncLogger logger;
+	EXPECT_STREQ(logs::info_level.c_str(), logger.get_log_level().c_str());
+	EXPECT_THROW(logger.log(logs::fatal_level, "fatal"), std::runtime_error);
+
+	jobs::AsyncLogger collected(sink);
+	collected.log(logs::debug_level, "before");
+	collected.log(logs::FATAL, "after");
+	std::lock_guard<std::mutex> gate(sink->gate_);
+	EXPECT_EQ((types::StringsT{"before", "after"}), sink->msgs_);
+}
+
+
+TEST(JOBS, AsyncLoggerGlobalLevel)
+{
+	auto logger = std::make_shared<jobs::AsyncLogger>();
+	logs::set_logger(logger);
+	EXPECT_FALSE(logs::log_enabled(logs::DEBUG));
+
+	logger->set_log_level(logs::debug_level);
+	EXPECT_STREQ(logs::debug_level.c_str(), logger->get_log_level().c_str());
+	EXPECT_TRUE(logs::log_enabled(logs::DEBUG));
+
+	logs::set_log_level(logs::warn_level);
+	EXPECT_STREQ(logs::warn_level.c_str(), logs::get_log_level().c_str());
+	EXPECT_FALSE(logs::log_enabled(logs::INFO));
+	logs::set_logger(std::make_shared<logs::DefLogger>());
+}
+
+TEST(JOBS, ChaseLevDeque)
+{
+	jobs::ChaseLevDeque<size_t> deque(2);
+	size_t out;
+	EXPECT_FALSE(deque.pop(out));
+	EXPECT_FALSE(deque.steal(out));
+	for (size_t i = 0; i < 5; ++i)
+	{
+		deque.push(i);
+	}
+	EXPECT_EQ(5, deque.size());
+	ASSERT_TRUE(deque.steal(out));
+	EXPECT_EQ(0, out);
+	ASSERT_TRUE(deque.pop(out));
+	EXPECT_EQ(4, out);
+	ASSERT_TRUE(deque.steal(out));
+	EXPECT_EQ(1, out);
+	ASSERT_TRUE(deque.pop(out));
+	EXPECT_EQ(3, out);
+	ASSERT_TRUE(deque.pop(out));
+	EXPECT_EQ(2, out);
+	EXPECT_FALSE(deque.pop(out));
+	EXPECT_FALSE(deque.steal(out));
+
+	// every value is taken once by the owner or a thief
+	const size_t nthieves = 3;
+	const size_t nvalues = 20000;
+	std::vector<std::atomic<size_t>> taken(nvalues);
+	std::atomic<bool> done = false;
+	std::vector<std::thread> thieves;
+	for (size_t i = 0; i < nthieves; ++i)
+	{
+		thieves.push_back(std::thread([&]
+		{
+			size_t val;
+			while (false == done.load() || deque.size() > 0)
+			{
+				if (deque.steal(val))
+				{
+					taken[val].fetch_add(1);
+				}
+			}
+		}));
+	}
+	for (size_t i = 0; i < nvalues; ++i)
+	{
+		deque.push(i);
+		if (i % 3 == 0 && deque.pop(out))
+		{
+			taken[out].fetch_add(1);
+		}
+	}
+	while (deque.pop(out))
+	{
+		taken[out].fetch_add(1);
+	}
+	done = true;
+	for (auto& thief : thieves)
+	{
+		thief.join();
+	}
+	for (size_t i = 0; i < nvalues; ++i)
+	{
+		ASSERT_EQ(1, taken[i].load()) << "value " << i;
+	}
+}
+
+
+TEST(JOBS, ThreadPoolSubmit)
+{
+	jobs::ThreadPool pool(4);
+	EXPECT_EQ(4, pool.size());
+
+	std::vector<std::future<size_t>> squares;
+	for (size_t i = 0; i < 100; ++i)
+	{
+		squares.push_back(pool.submit([](size_t x){ return x * x; }, i));
+	}
+	for (size_t i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(i * i, squares[i].get());
+	}
+
+	auto failed = pool.submit([]{ throw std::runtime_error("task failed"); });
+	EXPECT_THROW(failed.get(), std::runtime_error);
+
+	// tasks submitted by tasks go to the submitting worker's deque
+	std::atomic<size_t> nran = 0;
+	auto outer = pool.submit([&]
+	{
+		std::vector<std::future<void>> inner;
+		for (size_t i = 0; i < 50; ++i)
+		{
+			inner.push_back(pool.submit([&nran]{ nran.fetch_add(1); }));
+		}
+		return inner;
+	});
+	for (auto& inner : outer.get())
+	{
+		inner.wait();
+	}
+	EXPECT_EQ(50, nran.load());
+}
+
+
+TEST(JOBS, ThreadPoolParallelFor)
+{
+	jobs::ThreadPool pool(4);
+	const size_t n = 10000;
+	std::vector<size_t> visits(n, 0);
+	pool.parallel_for(0, n, [&visits](size_t i){ ++visits[i]; });
+	EXPECT_EQ(std::vector<size_t>(n, 1), visits);
+
+	std::atomic<size_t> sum = 0;
+	pool.parallel_for(10, 20, [&sum](size_t i){ sum.fetch_add(i); }, 3);
+	EXPECT_EQ(145, sum.load());
+	pool.parallel_for(5, 5, [](size_t){ FAIL() << "empty range"; });
+
+	// tasks run parallel_for on their own pool without deadlocking
+	std::vector<std::future<size_t>> totals;
+	for (size_t t = 0; t < 8; ++t)
+	{
+		totals.push_back(pool.submit([&pool]
+		{
+			std::atomic<size_t> total = 0;
+			pool.parallel_for(0, 100,
+				[&total](size_t i){ total.fetch_add(i); }, 1);
+			return total.load();
+		}));
+	}
+	for (auto& total : totals)
+	{
+		EXPECT_EQ(4950, total.get());
+	}
+
+	try
+	{
+		pool.parallel_for(0, n, [](size_t i)
+		{
+			if (i == 42)
+			{
+				throw std::runtime_error("index 42");
+			}
+		});
+		FAIL() << "expecting parallel_for to rethrow";
+	}
+	catch (std::runtime_error& e)
+	{
+		EXPECT_STREQ("index 42", e.what());
+	}
+}
+
+
+/// Return seconds elapsed since start
+static double elapsed_since (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+
+/// Compares tasks per second of ThreadPool with 1 to 64 workers against
+/// Sequence, which runs each task on a thread of its own
+/// Run with --gtest_also_run_disabled_tests
+TEST(JOBS, DISABLED_ThreadPoolThroughput)
+{
+	const size_t ntasks = 100000;
+	const size_t nseq_tasks = 200;
+	auto task = [](size_t i)
+	{
+		size_t sum = 0;
+		for (size_t j = 0; j < 100; ++j)
+		{
+			sum += (i ^ j) * j;
+		}
+		return sum;
+	};
+
+	for (size_t nworkers = 1; nworkers <= 64; nworkers <<= 1)
+	{
+		jobs::ThreadPool pool(nworkers);
+		std::vector<std::future<size_t>> results;
+		results.reserve(ntasks);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < ntasks; ++i)
+		{
+			results.push_back(pool.submit(task, i));
+		}
+		for (size_t i = 0; i < ntasks; ++i)
+		{
+			EXPECT_EQ(task(i), results[i].get());
+		}
+		double secs = elapsed_since(start);
+		std::cout << "ThreadPool(" << nworkers << "): " <<
+			ntasks / secs << " tasks/s" << std::endl;
+	}
+
+	std::atomic<size_t> nran = 0;
+	auto start = std::chrono::steady_clock::now();
+	{
+		jobs::Sequence seq;
+		for (size_t i = 0; i < nseq_tasks; ++i)
+		{
+			seq.attach_job(
+			[&task, &nran](size_t, size_t i)
+			{
+				task(i);
+				nran.fetch_add(1);
+				return true;
+			}, i);
+		}
+		seq.join();
+	}
+	double secs = elapsed_since(start);
+	EXPECT_EQ(nseq_tasks, nran.load());
+	std::cout << "Sequence: " << nseq_tasks / secs << " tasks/s" << std::endl;
+}
+
+
+/// Stream buffer that discards everything written to it
+struct NullBuffer final : public std::streambuf
+{
+	int overflow (int c) override
+	{
+		return c;
+	}
+};
+
+
+/// Compares messages per second of 16 producer threads logging to
+/// DefLogger directly and through AsyncLogger, with output discarded
+/// Run with --gtest_also_run_disabled_tests
+TEST(JOBS, DISABLED_AsyncLoggerThroughput)
+{
+	const size_t nproducers = 16;
+	const size_t nmsgs = 20000;
+	NullBuffer discard;
+	std::streambuf* cout_buf = std::cout.rdbuf(&discard);
+	auto produce = [&](logs::iLogger& logger)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < nproducers; ++i)
+		{
+			producers.push_back(std::thread(
+			[&logger, i]
+			{
+				for (size_t j = 0; j < nmsgs; ++j)
+				{
+					logger.log(logs::INFO, fmts::sprintf("%zu %zu", i, j));
+				}
+			}));
+		}
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+		return elapsed_since(start);
+	};
+
+	logs::DefLogger direct;
+	double direct_secs = produce(direct);
+	double async_secs = 0;
+	double drained_secs = 0;
+	{
+		auto start = std::chrono::steady_clock::now();
+		jobs::AsyncLogger async(std::make_shared<logs::DefLogger>());
+		async_secs = produce(async);
+		async.flush();
+		drained_secs = elapsed_since(start);
+	}
+	std::cout.rdbuf(cout_buf);
+
+	size_t total = nproducers * nmsgs;
+	std::cout << "DefLogger: " << total / direct_secs << " msgs/s\n" <<
+		"AsyncLogger: " << total / async_secs << " msgs/s enqueued, " <<
+		total / drained_secs << " msgs/s drained" << std::endl;
+}
+
+
 #endif // DISABLE_JOB_TEST
@@ -0,0 +1,382 @@
+///
+/// thread_pool.hpp
+/// jobs
+///
+/// Purpose:
+/// Define pool of worker threads that balance tasks by stealing
+///
+
+#ifndef PKG_JOBS_THREAD_POOL_HPP
+#define PKG_JOBS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+#include "jobs/chase_lev_deque.hpp"
+
+namespace jobs
+{
+
+/// Number of chunks per worker parallel_for splits ranges into
+/// when not given a grain size
+const size_t parallel_chunks_per_worker = 4;
+
+/// Number of times idle workers look for tasks before sleeping
+const size_t pool_idle_spins = 64;
+
+/// Fixed set of worker threads, each with a ChaseLevDeque of tasks
+/// Tasks submitted by a worker go to its own deque, where it takes the
+/// newest first, tasks submitted by other threads go to a shared queue,
+/// and idle workers steal the oldest tasks of other workers' deques
+/// Destruction waits for every submitted task to finish
+struct ThreadPool final
+{
+	ThreadPool (size_t nworkers = std::max<size_t>(1,
+		std::thread::hardware_concurrency()))
+	{
+		nworkers = std::max<size_t>(1, nworkers);
+		for (size_t i = 0; i < nworkers; ++i)
+		{
+			deques_.push_back(std::make_unique<ChaseLevDeque<iTask*>>());
+		}
+		for (size_t i = 0; i < nworkers; ++i)
+		{
+			workers_.push_back(std::thread([this, i]{ work(i); }));
+		}
+	}
+
+	~ThreadPool (void)
+	{
+		{
+			std::lock_guard<std::mutex> guard(sleep_mtx_);
+			stopped_ = true;
+		}
+		wake_.notify_all();
+		for (auto& worker : workers_)
+		{
+			worker.join();
+		}
+	}
+
+	ThreadPool (const ThreadPool& other) = delete;
+
+	ThreadPool& operator = (const ThreadPool& other) = delete;
+
+	/// Return future of calling fn with args on a worker
+	/// Tasks waiting on futures of other tasks hold up their worker,
+	/// use parallel_for to wait on work split across the pool
+	template <typename FN, typename ...ARGS>
+	std::future<std::invoke_result_t<std::decay_t<FN>,std::decay_t<ARGS>...>>
+	submit (FN&& fn, ARGS&&... args)
+	{
+		using RetT = std::invoke_result_t<
+			std::decay_t<FN>,std::decay_t<ARGS>...>;
+		std::packaged_task<RetT()> task(
+			[fn = std::forward<FN>(fn),
+			args = std::make_tuple(std::forward<ARGS>(args)...)]() mutable
+			{
+				return std::apply(fn, std::move(args));
+			});
+		auto out = task.get_future();
+		enqueue(new Task<std::packaged_task<RetT()>>(std::move(task)));
+		return out;
+	}
+
+	/// Call fn with every index from begin to end, in chunks of grain
+	/// indices (or parallel_chunks_per_worker chunks per worker if 0)
+	/// that workers and the calling thread claim until none are left
+	/// The calling thread runs other tasks while chunks are in progress,
+	/// so tasks may call parallel_for on the pool running them
+	/// Rethrow the first exception thrown by fn, after which
+	/// unstarted chunks are skipped
+	template <typename FN>
+	void parallel_for (size_t begin, size_t end, FN&& fn, size_t grain = 0)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		size_t n = end - begin;
+		if (grain == 0)
+		{
+			grain = std::max<size_t>(1,
+				n / (deques_.size() * parallel_chunks_per_worker));
+		}
+		auto range = std::make_shared<ForRange<std::remove_reference_t<FN>>>(
+			&fn, begin, end, grain);
+		size_t nhelpers = std::min(range->nchunks_ - 1, deques_.size());
+		for (size_t i = 0; i < nhelpers; ++i)
+		{
+			// helpers starting after the last chunk claim nothing,
+			// so they never touch fn once parallel_for returns
+			auto helper = [range]{ range->run(); };
+			enqueue(new Task<decltype(helper)>(std::move(helper)));
+		}
+		range->run();
+		while (range->ndone_.load(std::memory_order_acquire) <
+			range->nchunks_)
+		{
+			if (false == run_one())
+			{
+				std::this_thread::yield();
+			}
+		}
+		// late helpers may release range, so take the exception from it
+		std::exception_ptr err;
+		std::swap(err, range->err_);
+		if (err)
+		{
+			std::rethrow_exception(err);
+		}
+	}
+
+	/// Return the number of workers
+	size_t size (void) const
+	{
+		return workers_.size();
+	}
+
+private:
+	/// Type-erased task run once by a worker
+	struct iTask
+	{
+		virtual ~iTask (void) = default;
+
+		virtual void run (void) = 0;
+	};
+
+	template <typename FN>
+	struct Task final : public iTask
+	{
+		Task (FN&& fn) : fn_(std::move(fn)) {}
+
+		void run (void) override
+		{
+			fn_();
+		}
+
+		FN fn_;
+	};
+
+	/// Chunks of a parallel_for shared by the threads claiming them
+	template <typename FN>
+	struct ForRange final
+	{
+		ForRange (FN* fn, size_t begin, size_t end, size_t grain) :
+			fn_(fn), begin_(begin), end_(end), grain_(grain),
+			nchunks_((end - begin + grain - 1) / grain) {}
+
+		/// Run chunks until every chunk is claimed
+		void run (void)
+		{
+			for (size_t chunk = next_.fetch_add(1, std::memory_order_relaxed);
+				chunk < nchunks_;
+				chunk = next_.fetch_add(1, std::memory_order_relaxed))
+			{
+				if (false == failed_.load(std::memory_order_relaxed))
+				{
+					size_t lo = begin_ + chunk * grain_;
+					size_t hi = std::min(lo + grain_, end_);
+					try
+					{
+						for (size_t i = lo; i < hi; ++i)
+						{
+							(*fn_)(i);
+						}
+					}
+					catch (...)
+					{
+						if (false == failed_.exchange(true))
+						{
+							err_ = std::current_exception();
+						}
+					}
+				}
+				ndone_.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		FN* fn_;
+
+		size_t begin_;
+
+		size_t end_;
+
+		size_t grain_;
+
+		size_t nchunks_;
+
+		std::atomic<size_t> next_ = 0;
+
+		std::atomic<size_t> ndone_ = 0;
+
+		/// Set by the only thread that writes err_
+		std::atomic<bool> failed_ = false;
+
+		std::exception_ptr err_;
+	};
+
+	/// Pool and index of the worker running on the calling thread if any
+	struct WorkerId final
+	{
+		ThreadPool* pool_;
+
+		size_t index_;
+	};
+
+	static WorkerId& current_worker (void)
+	{
+		thread_local WorkerId id{nullptr, 0};
+		return id;
+	}
+
+	void enqueue (iTask* task)
+	{
+		// counted before it is queued, so it is never taken uncounted
+		npending_.fetch_add(1);
+		WorkerId& id = current_worker();
+		if (id.pool_ == this)
+		{
+			deques_[id.index_]->push(task);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> guard(inject_mtx_);
+			injected_.push_back(task);
+			ninjected_.fetch_add(1, std::memory_order_relaxed);
+		}
+		// workers count themselves sleeping before checking npending_,
+		// so either they see this task or this sees them
+		if (nsleeping_.load() > 0)
+		{
+			{
+				std::lock_guard<std::mutex> guard(sleep_mtx_);
+			}
+			wake_.notify_one();
+		}
+	}
+
+	/// Return a task taken from the deque of worker index (if it is one
+	/// of this pool's), the shared queue or another worker, otherwise null
+	iTask* find_task (size_t index)
+	{
+		size_t n = deques_.size();
+		iTask* task = nullptr;
+		if ((index < n && deques_[index]->pop(task)) || take_injected(task))
+		{
+			npending_.fetch_sub(1);
+			return task;
+		}
+		thread_local size_t victim = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			victim = (victim + 1) % n;
+			if (victim != index && deques_[victim]->steal(task))
+			{
+				npending_.fetch_sub(1);
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	bool take_injected (iTask*& task)
+	{
+		if (ninjected_.load(std::memory_order_relaxed) == 0)
+		{
+			return false;
+		}
+		std::lock_guard<std::mutex> guard(inject_mtx_);
+		if (injected_.empty())
+		{
+			return false;
+		}
+		task = injected_.front();
+		injected_.pop_front();
+		ninjected_.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/// Return true after running a task found by the calling thread
+	bool run_one (void)
+	{
+		WorkerId& id = current_worker();
+		iTask* task = find_task(id.pool_ == this ?
+			id.index_ : deques_.size());
+		if (nullptr == task)
+		{
+			return false;
+		}
+		task->run();
+		delete task;
+		return true;
+	}
+
+	void work (size_t index)
+	{
+		current_worker() = WorkerId{this, index};
+		while (true)
+		{
+			bool ran = false;
+			for (size_t i = 0; i < pool_idle_spins && false == ran; ++i)
+			{
+				ran = run_one();
+				if (false == ran)
+				{
+					std::this_thread::yield();
+				}
+			}
+			if (ran)
+			{
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleep_mtx_);
+			nsleeping_.fetch_add(1);
+			wake_.wait(lock, [this]
+			{
+				return stopped_ || npending_.load() > 0;
+			});
+			nsleeping_.fetch_sub(1);
+			if (stopped_ && npending_.load() <= 0)
+			{
+				return;
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<ChaseLevDeque<iTask*>>> deques_;
+
+	/// Tasks submitted by threads other than workers
+	std::deque<iTask*> injected_;
+
+	std::mutex inject_mtx_;
+
+	std::atomic<size_t> ninjected_ = 0;
+
+	/// Number of queued tasks, which is briefly ahead of the queues
+	/// while tasks are being queued
+	alignas(cache_line_size) std::atomic<int64_t> npending_ = 0;
+
+	std::atomic<size_t> nsleeping_ = 0;
+
+	/// Guards stopped_ and sleeping workers
+	std::mutex sleep_mtx_;
+
+	std::condition_variable wake_;
+
+	bool stopped_ = false;
+
+	/// Declared last, so workers start after the members they use
+	std::vector<std::thread> workers_;
+};
+
+}
+
+#endif // PKG_JOBS_THREAD_POOL_HPP
@@ -0,0 +1,219 @@
+///
+/// binlog.hpp
+/// logs
+///
+/// Purpose:
+/// Define binary log records that defer printf formatting to a decoder
+///
+/// a binary log is a sequence of records in host byte order, each starting
+/// with a RecordTag byte where
+/// FORMAT_RECORD is followed by <u64 id><u32 size><string bytes>
+/// and defines the format or file of later DEFERRED_RECORDs with the id,
+/// DEFERRED_RECORD is followed by <u8 level><u64 file id><u32 line>
+/// <u64 format id><u8 nargs> where file and line locate the log call, then
+/// nargs arguments, each an ArgTag byte followed by 8 value bytes
+/// or by <u32 size><string bytes> for STR_ARG,
+/// and TEXT_RECORD is followed by <u8 level><u32 line><u32 size><file bytes>
+/// <u32 size><message bytes> where line and file locate the log call
+///
+
+#ifndef PKG_LOGS_BINLOG_HPP
+#define PKG_LOGS_BINLOG_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <type_traits>
+#include <unordered_set>
+
+#include "logs/ilogs.hpp"
+#include "logs/sink.hpp"
+
+namespace logs
+{
+
+/// Encoding of binary log records
+enum RecordTag : uint8_t
+{
+	FORMAT_RECORD = 0,
+	DEFERRED_RECORD,
+	TEXT_RECORD,
+};
+
+/// Encoding of printf arguments in deferred records
+enum ArgTag : uint8_t
+{
+	INT_ARG = 0,
+	UINT_ARG,
+	FLOAT_ARG,
+	PTR_ARG,
+	STR_ARG,
+};
+
+/// Append bytes of value to buf
+template <typename T>
+void append_raw (std::string& buf, const T& value)
+{
+	buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Append ArgTag and bytes of printf argument to buf
+template <typename T>
+void append_arg (std::string& buf, T arg)
+{
+	if constexpr (std::is_enum_v<T>)
+	{
+		append_arg(buf, static_cast<std::underlying_type_t<T>>(arg));
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		buf.push_back(FLOAT_ARG);
+		append_raw(buf, static_cast<double>(arg));
+	}
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+	{
+		buf.push_back(INT_ARG);
+		append_raw(buf, static_cast<int64_t>(arg));
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		buf.push_back(UINT_ARG);
+		append_raw(buf, static_cast<uint64_t>(arg));
+	}
+	else if constexpr (std::is_same_v<T,const char*> || std::is_same_v<T,char*>)
+	{
+		const char* str = nullptr == arg ? "(null)" : arg;
+		uint32_t n = std::strlen(str);
+		buf.push_back(STR_ARG);
+		append_raw(buf, n);
+		buf.append(str, n);
+	}
+	else
+	{
+		static_assert(std::is_pointer_v<T>,
+			"binary log arguments must be printf arithmetic, string or pointer");
+		buf.push_back(PTR_ARG);
+		append_raw(buf, static_cast<uint64_t>(
+			reinterpret_cast<uintptr_t>(arg)));
+	}
+}
+
+/// Format string literal with the location of the log call passing it,
+/// which iDeferLogger records by address, since literals outlive loggers
+/// and are never replaced by other strings at the same address
+/// Only constant char arrays convert to it, so formats held in buffers
+/// or strings (e.g.: std::string::c_str()) are formatted before logging
+struct FormatLiteral final
+{
+	template <size_t N>
+	FormatLiteral (const char (&format)[N],
+		const SrcLocT& location = SrcLocT::current()) :
+		format_(format), location_(location) {}
+
+	template <size_t N>
+	FormatLiteral (char (&format)[N]) = delete;
+
+	const char* format_;
+
+	SrcLocT location_;
+};
+
+/// Void if FORMAT is a format that does not convert to FormatLiteral,
+/// so overloads taking it are only chosen for formats that are not literals
+template <typename FORMAT>
+using NonLiteralT = std::enable_if_t<
+	false == std::is_convertible<FORMAT,FormatLiteral>::value>;
+
+/// Logger that receives the arguments of format helpers (e.g.: infof)
+/// unformatted, the global logger gets them when given a format literal
+struct iDeferLogger : public iLogger
+{
+	virtual ~iDeferLogger (void) = default;
+
+	/// Return the calling thread's buffer after appending the header of
+	/// a record of nargs arguments for format, or return null without
+	/// beginning a record if the logger drops messages at msg_level,
+	/// unless the record is unfiltered like iLogger::log_unfiltered
+	/// Callers append nargs arguments using append_arg then call end_record
+	/// Fatal messages go through log, so they are handled like log does
+	virtual std::string* begin_record (size_t msg_level,
+		const FormatLiteral& format, uint8_t nargs, bool unfiltered) = 0;
+
+	/// Complete the record begun by the calling thread
+	virtual void end_record (void) = 0;
+};
+
+/// Logger that appends binary records to per-thread buffers,
+/// which are written to a sink in batches
+/// Use decode_binlog to render the output as text
+struct BinaryLogger final : public iDeferLogger
+{
+	BinaryLogger (std::shared_ptr<iSink> sink,
+		size_t flush_size = batch_flush_size,
+		std::chrono::milliseconds flush_interval = batch_flush_interval);
+
+	BinaryLogger (const BinaryLogger& other) = delete;
+
+	BinaryLogger& operator = (const BinaryLogger& other) = delete;
+
+	/// Implementation of iLogger
+	std::string get_log_level (void) const override;
+
+	/// Implementation of iLogger
+	void set_log_level (const std::string& log_level) override;
+
+	/// Implementation of iLogger
+	bool syncs_log_level (void) const override
+	{
+		return true;
+	}
+
+	/// Implementation of iLogger
+	bool supports_level (size_t msg_level) const override;
+
+	/// Implementation of iLogger
+	bool supports_level (const std::string& msg_level) const override;
+
+	/// Implementation of iLogger
+	void log (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Implementation of iLogger
+	void log (const std::string& msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Implementation of iLogger
+	/// Fatal messages are written with every buffered record before throwing
+	void log_unfiltered (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Implementation of iDeferLogger
+	std::string* begin_record (size_t msg_level,
+		const FormatLiteral& format, uint8_t nargs, bool unfiltered) override;
+
+	/// Implementation of iDeferLogger
+	void end_record (void) override;
+
+	/// Write every thread's buffered records to the sink
+	void flush (void);
+
+private:
+	/// Formats and files already defined in records of a thread's buffer
+	using FormatsT = std::unordered_set<const char*>;
+
+	/// Messages above this level are not recorded
+	std::atomic<size_t> log_level_;
+
+	/// Buffers are held locked from begin_record to end_record
+	ThreadBatcher<FormatsT> batcher_;
+};
+
+/// Write text of every record of binary log in, one line per record
+/// of the form level:file:line-message, where file and line locate
+/// the log call
+/// Throw std::runtime_error if in is malformed
+void decode_binlog (std::ostream& out, std::istream& in);
+
+}
+
+#endif // PKG_LOGS_BINLOG_HPP
@@ -2,28 +2,58 @@
 #ifndef PKG_LOGS_ILOGS_HPP
 #define PKG_LOGS_ILOGS_HPP
 
+#include <cstdint>
 #include <string>
 
-namespace std
+#if __cplusplus >= 202002L && __has_include(<source_location>)
+#include <source_location>
+#endif
+
+namespace logs
 {
 
-struct source_location
+#if __cplusplus >= 202002L && __has_include(<source_location>)
+
+using SrcLocT = std::source_location;
+
+#else
+
+/// Source location captured where current is called, including where it is
+/// a default argument, standing in for C++20 std::source_location
+struct SrcLoc final
 {
-	static source_location current (void) { return source_location(); }
+	static constexpr SrcLoc current (
+		const char* file = __builtin_FILE(),
+		std::uint32_t line = __builtin_LINE(),
+		const char* function = __builtin_FUNCTION()) noexcept
+	{
+		SrcLoc location;
+		location.file_ = file;
+		location.line_ = line;
+		location.function_ = function;
+		return location;
+	}
 
-	const char* file_name (void) const noexcept { return ""; }
+	constexpr const char* file_name (void) const noexcept { return file_; }
 
-	std::uint32_t line (void) const noexcept { return 0; }
+	constexpr std::uint32_t line (void) const noexcept { return line_; }
 
-	const char* function_name (void) const noexcept { return ""; }
-};
+	constexpr const char* function_name (void) const noexcept
+	{
+		return function_;
+	}
 
-}
+private:
+	const char* file_ = "";
 
-namespace logs
-{
+	std::uint32_t line_ = 0;
 
-using SrcLocT = std::source_location;
+	const char* function_ = "";
+};
+
+using SrcLocT = SrcLoc;
+
+#endif
 
 /// Interface of logger
 struct iLogger
@@ -49,6 +79,24 @@ struct iLogger
 	/// Log message at any specified string level of verbosity
 	virtual void log (const std::string& msg_level, const std::string& msg,
 		const SrcLocT& location = SrcLocT::current()) = 0;
+
+	/// Log message at enum level that global log functions enabled through
+	/// their level checks or a LogSite, whose level may be more verbose than
+	/// this logger's level (e.g.: a module level set by set_module_levels)
+	/// Defaults to log, so loggers that do not override it still filter
+	virtual void log_unfiltered (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current())
+	{
+		log(msg_level, msg, location);
+	}
+
+	/// Return true if this logger calls logs::sync_log_level whenever its
+	/// level changes, so global helpers may skip messages above its level
+	/// without calling log, otherwise every message reaches log
+	virtual bool syncs_log_level (void) const
+	{
+		return false;
+	}
 };
 
 }
@@ -9,11 +9,17 @@
 #ifndef PKG_LOGS_HPP
 #define PKG_LOGS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 
 #include "fmts/fmts.hpp"
 #include "logs/ilogs.hpp"
+#include "logs/binlog.hpp"
 
 namespace logs
 {
@@ -77,6 +83,28 @@ std::string name_log (const LOG_LEVEL& level);
 
 LOG_LEVEL enum_log (const std::string& level);
 
+/// Return enum level named by level ignoring case, or NOT_SET if none
+LOG_LEVEL enum_log_nocase (const std::string& level);
+
+/// Enum level of the global logger cached for level checks,
+/// or NOT_SET if the global logger's level is not named in names2log
+/// or the logger does not sync its level (see iLogger::syncs_log_level)
+/// in which case every message reaches the global logger
+/// Use log_enabled instead of reading this directly
+extern std::atomic<size_t> global_log_level;
+
+/// Return true if messages at msg_level reach the global logger
+/// This costs a relaxed load, so disabled messages skip formatting
+inline bool log_enabled (size_t msg_level)
+{
+	return msg_level <= global_log_level.load(std::memory_order_relaxed);
+}
+
+/// Update global_log_level if logger is the global logger
+/// Loggers whose syncs_log_level returns true must call this whenever
+/// their level changes, otherwise the cache drops messages they now accept
+void sync_log_level (const iLogger& logger);
+
 /// Default implementation of iLogger used in ADE
 struct DefLogger final : public iLogger
 {
@@ -93,9 +121,16 @@ struct DefLogger final : public iLogger
 		if (names2log.end() != it)
 		{
 			log_level_ = names2log.at(log_level);
+			sync_log_level(*this);
 		}
 	}
 
+	/// Implementation of iLogger
+	bool syncs_log_level (void) const override
+	{
+		return true;
+	}
+
 	bool supports_level (size_t msg_level) const override
 	{
 		return msg_level < NOT_SET;
@@ -103,11 +138,7 @@ struct DefLogger final : public iLogger
 
 	bool supports_level (const std::string& msg_level) const override
 	{
-		std::string level = msg_level;
-		std::transform(level.begin(), level.end(), level.begin(),
-			[](unsigned char c){ return std::tolower(c); });
-		auto it = names2log.find(level);
-		return names2log.end() != it;
+		return NOT_SET != enum_log_nocase(msg_level);
 	}
 
 	/// Implementation of iLogger
@@ -129,20 +160,27 @@ struct DefLogger final : public iLogger
 	{
 		if (msg_level <= log_level_)
 		{
-			switch (msg_level)
-			{
-				case FATAL:
-					fatal(msg);
-					[[fallthrough]];
-				case ERROR:
-					error(msg);
-					break;
-				case WARN:
-					warn(msg);
-					break;
-				default:
-					std::cout << location.file_name() << ":" << location.line() << "-" << msg << '\n';
-			}
+			log_unfiltered(msg_level, msg, location);
+		}
+	}
+
+	/// Implementation of iLogger
+	void log_unfiltered (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override
+	{
+		switch (msg_level)
+		{
+			case FATAL:
+				fatal(msg);
+				[[fallthrough]];
+			case ERROR:
+				error(msg);
+				break;
+			case WARN:
+				warn(msg);
+				break;
+			default:
+				std::cout << location.file_name() << ":" << location.line() << "-" << msg << '\n';
 		}
 	}
 
@@ -150,19 +188,13 @@ private:
 	/// Warn user of message regarding poor decisions
 	void warn (const std::string& msg) const
 	{
-		if (WARN <= log_level_)
-		{
-			std::cerr << warn_tag << msg << '\n';
-		}
+		std::cerr << warn_tag << msg << '\n';
 	}
 
 	/// Notify user of message regarding recoverable error
 	void error (const std::string& msg) const
 	{
-		if (ERROR <= log_level_)
-		{
-			std::cerr << err_tag << msg << '\n';
-		}
+		std::cerr << err_tag << msg << '\n';
 	}
 
 	/// Notify user of message regarding fatal error, then finish him
@@ -175,12 +207,145 @@ private:
 	LOG_LEVEL log_level_ = INFO;
 };
 
+/// Logger that writes DefLogger's lines into per-thread buffers,
+/// which are written to a sink in batches instead of a stream per message
+struct SinkLogger final : public iLogger
+{
+	SinkLogger (std::shared_ptr<iSink> sink,
+		size_t flush_size = batch_flush_size,
+		std::chrono::milliseconds flush_interval = batch_flush_interval) :
+		batcher_(sink, flush_size, flush_interval) {}
+
+	/// Implementation of iLogger
+	std::string get_log_level (void) const override;
+
+	/// Implementation of iLogger
+	void set_log_level (const std::string& log_level) override;
+
+	/// Implementation of iLogger
+	bool syncs_log_level (void) const override
+	{
+		return true;
+	}
+
+	/// Implementation of iLogger
+	bool supports_level (size_t msg_level) const override;
+
+	/// Implementation of iLogger
+	bool supports_level (const std::string& msg_level) const override;
+
+	/// Implementation of iLogger
+	void log (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Implementation of iLogger
+	/// Fatal messages are written with every buffered line before throwing
+	void log_unfiltered (size_t msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Implementation of iLogger
+	void log (const std::string& msg_level, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) override;
+
+	/// Write every thread's buffered lines to the sink
+	void flush (void);
+
+private:
+	/// Logging levels above this log_level_ are ignored
+	std::atomic<size_t> log_level_ = INFO;
+
+	ThreadBatcher<> batcher_;
+};
+
+/// Level name resolved once to its enum level, so callers that name
+/// levels with strings log at an enum level instead of loggers looking up
+/// the name for every message
+struct LevelHandle final
+{
+	LevelHandle (LOG_LEVEL level) : level_(level), name_(name_log(level)) {}
+
+	/// Resolve name ignoring case
+	LevelHandle (const std::string& name) :
+		level_(enum_log_nocase(name)), name_(name) {}
+
+	/// Log msg at this level using logger, where logger gets the name
+	/// only if the name is not in names2log
+	void log (iLogger& logger, const std::string& msg,
+		const SrcLocT& location = SrcLocT::current()) const
+	{
+		if (level_ < NOT_SET)
+		{
+			logger.log(level_, msg, location);
+		}
+		else
+		{
+			logger.log(name_, msg, location);
+		}
+	}
+
+	/// Return true if logger supports this level
+	bool supported_by (const iLogger& logger) const
+	{
+		return level_ < NOT_SET ?
+			logger.supports_level(level_) : logger.supports_level(name_);
+	}
+
+	/// Enum level, NOT_SET if name is not in names2log
+	size_t level_;
+
+	/// Name as given
+	std::string name_;
+};
+
 /// Set input logger for ADE global logger
+/// The replaced logger is released once every LoggerGuard that may read it
+/// ends, or by a later call if the calling thread is in a LoggerGuard
 void set_logger (std::shared_ptr<iLogger> logger);
 
-/// Get reference to ADE global logger
+/// Get reference to ADE global logger, which stays valid until the next
+/// set_logger call, use a LoggerGuard to log while loggers may be swapped
 iLogger& get_logger (void);
 
+/// Per-thread reader state of the global logger
+struct ReaderSlot;
+
+/// Section during which the global logger it reads is not destroyed, even
+/// if set_logger replaces it, so logging never races with set_logger
+/// Entering costs a store to the calling thread's slot, without locking
+/// or waiting, and nested sections only count their depth
+/// set_logger waits for sections that began before it to end,
+/// so sections must not wait on threads calling set_logger
+struct LoggerGuard final
+{
+	LoggerGuard (void);
+
+	~LoggerGuard (void);
+
+	LoggerGuard (const LoggerGuard& other) = delete;
+
+	LoggerGuard& operator = (const LoggerGuard& other) = delete;
+
+	/// Return the global logger when this section began
+	iLogger& logger (void) const
+	{
+		return *logger_;
+	}
+
+	/// Return the global logger if it is an iDeferLogger, otherwise null
+	/// Format helpers given a format literal hand it unformatted arguments
+	iDeferLogger* defer_logger (void) const
+	{
+		return defer_;
+	}
+
+private:
+	ReaderSlot* slot_;
+
+	iLogger* logger_;
+
+	iDeferLogger* defer_;
+};
+
 /// Return log level used by global logger
 std::string get_log_level (void);
 
@@ -188,56 +353,151 @@ std::string get_log_level (void);
 void set_log_level (const std::string& log_level);
 
 /// Log at trace level using global logger
-void trace (const std::string& msg);
+void trace (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
 
 /// Log at debug level using global logger
-void debug (const std::string& msg);
+void debug (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
 
 /// Log at info level using global logger
-void info (const std::string& msg);
+void info (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
 
 /// Warn using global logger
-void warn (const std::string& msg);
+void warn (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
 
 /// Error using global logger
-void error (const std::string& msg);
+void error (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
 
 /// Fatal using global logger
-void fatal (const std::string& msg);
+void fatal (const std::string& msg,
+	const SrcLocT& location = SrcLocT::current());
+
+/// Log at enum level using global logger with arguments of format
+/// that is not a literal (e.g.: std::string or char buffer)
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> levelf (size_t msg_level, FORMAT&& format, ARGS... args)
+{
+	if (log_enabled(msg_level))
+	{
+		LoggerGuard guard;
+		guard.logger().log_unfiltered(msg_level,
+			fmts::sprintf(format, args...));
+	}
+}
+
+/// Return true after handing arguments of a message enabled by the
+/// caller's level check to the global logger of guard if it is an
+/// iDeferLogger
+/// Fatal messages are never deferred, so they reach the logger's log
+template <typename... ARGS>
+bool deferf (const LoggerGuard& guard, size_t msg_level,
+	const FormatLiteral& format, ARGS... args)
+{
+	static_assert(sizeof...(ARGS) <= std::numeric_limits<uint8_t>::max(),
+		"too many arguments to log");
+	iDeferLogger* logger = guard.defer_logger();
+	if (nullptr == logger || msg_level == FATAL)
+	{
+		return false;
+	}
+	std::string* record = logger->begin_record(
+		msg_level, format, sizeof...(ARGS), true);
+	if (nullptr != record)
+	{
+		(append_arg(*record, args), ...);
+		logger->end_record();
+	}
+	return true;
+}
+
+/// Log at enum level using global logger with arguments of format
+/// literal, which an iDeferLogger records without formatting
+template <typename... ARGS>
+void levelf (size_t msg_level, const FormatLiteral& format, ARGS... args)
+{
+	if (log_enabled(msg_level))
+	{
+		LoggerGuard guard;
+		if (false == deferf(guard, msg_level, format, args...))
+		{
+			guard.logger().log_unfiltered(msg_level,
+				fmts::sprintf(format.format_, args...), format.location_);
+		}
+	}
+}
 
 /// Log at trace level using global logger with arguments
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> tracef (FORMAT&& format, ARGS... args)
+{
+	levelf(TRACE, std::forward<FORMAT>(format), args...);
+}
+
+/// Log at trace level using global logger with arguments of format literal
 template <typename... ARGS>
-void tracef (std::string format, ARGS... args)
+void tracef (const FormatLiteral& format, ARGS... args)
 {
-	trace(fmts::sprintf(format, args...));
+	levelf(TRACE, format, args...);
 }
 
 /// Log at debug level using global logger with arguments
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> debugf (FORMAT&& format, ARGS... args)
+{
+	levelf(DEBUG, std::forward<FORMAT>(format), args...);
+}
+
+/// Log at debug level using global logger with arguments of format literal
 template <typename... ARGS>
-void debugf (std::string format, ARGS... args)
+void debugf (const FormatLiteral& format, ARGS... args)
 {
-	debug(fmts::sprintf(format, args...));
+	levelf(DEBUG, format, args...);
 }
 
 /// Log at info level using global logger with arguments
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> infof (FORMAT&& format, ARGS... args)
+{
+	levelf(INFO, std::forward<FORMAT>(format), args...);
+}
+
+/// Log at info level using global logger with arguments of format literal
 template <typename... ARGS>
-void infof (std::string format, ARGS... args)
+void infof (const FormatLiteral& format, ARGS... args)
 {
-	info(fmts::sprintf(format, args...));
+	levelf(INFO, format, args...);
 }
 
 /// Warn using global logger with arguments
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> warnf (FORMAT&& format, ARGS... args)
+{
+	levelf(WARN, std::forward<FORMAT>(format), args...);
+}
+
+/// Warn using global logger with arguments of format literal
 template <typename... ARGS>
-void warnf (std::string format, ARGS... args)
+void warnf (const FormatLiteral& format, ARGS... args)
 {
-	warn(fmts::sprintf(format, args...));
+	levelf(WARN, format, args...);
 }
 
 /// Error using global logger with arguments
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> errorf (FORMAT&& format, ARGS... args)
+{
+	levelf(ERROR, std::forward<FORMAT>(format), args...);
+}
+
+/// Error using global logger with arguments of format literal
 template <typename... ARGS>
-void errorf (std::string format, ARGS... args)
+void errorf (const FormatLiteral& format, ARGS... args)
 {
-	error(fmts::sprintf(format, args...));
+	levelf(ERROR, format, args...);
 }
 
 /// Fatal using global logger with arguments
@@ -247,6 +507,330 @@ void fatalf (std::string format, ARGS... args)
 	fatal(fmts::sprintf(format, args...));
 }
 
+/// Name of environment variable read by set_module_levels_env
+const std::string module_levels_env = "LOGS_MODULE_LEVELS";
+
+/// Threshold of a LogSite that is not yet reached
+const uint8_t unresolved_site = std::numeric_limits<uint8_t>::max();
+
+/// Log call whose level, module and location are fixed at compile time
+/// Sites register the first time they are reached (or set), after which
+/// for_each_site visits them, and changes to module levels, the global
+/// logger's level or the site's enabled state update their threshold
+/// Sites are never unregistered, so they must be static (e.g.: LOGS_LOGF)
+struct LogSite final
+{
+	/// Site's module is the file of location if module is null
+	constexpr LogSite (size_t level, const char* module = nullptr,
+		SrcLocT location = SrcLocT::current()) :
+		location_(location), module_(module), level_(level) {}
+
+	LogSite (const LogSite& other) = delete;
+
+	LogSite& operator = (const LogSite& other) = delete;
+
+	/// Return true if messages at this site reach the global logger
+	bool enabled (void)
+	{
+		uint8_t threshold = threshold_.load(std::memory_order_relaxed);
+		if (threshold == unresolved_site)
+		{
+			threshold = register_site();
+		}
+		return level_ < threshold;
+	}
+
+	/// Return true if this site's state decides whether its messages
+	/// are logged, rather than the level of the logger they reach,
+	/// which is the case once a module level of set_module_levels
+	/// matches it or it is disabled
+	bool overrides_logger (void)
+	{
+		if (threshold_.load(std::memory_order_relaxed) == unresolved_site)
+		{
+			register_site();
+		}
+		return overrides_logger_.load(std::memory_order_relaxed);
+	}
+
+	/// Enable or disable messages at this site
+	void set_enabled (bool enabled);
+
+	/// Return the module name matched against set_module_levels
+	const char* module_name (void) const
+	{
+		return nullptr == module_ ? location_.file_name() : module_;
+	}
+
+	SrcLocT location_;
+
+	const char* module_;
+
+	size_t level_;
+
+private:
+	friend void for_each_site (const std::function<void(LogSite&)>&);
+
+	friend void refresh_sites (void);
+
+	/// Add this site to the registered sites if it is not registered,
+	/// then return its threshold
+	uint8_t register_site (void);
+
+	/// Set threshold from module levels and the global logger's level,
+	/// the registry's lock must be held
+	void resolve (size_t global_level);
+
+	/// Messages at levels below this are logged, so 0 disables the site
+	std::atomic<uint8_t> threshold_ = unresolved_site;
+
+	/// Set with threshold_ by resolve (see overrides_logger)
+	std::atomic<bool> overrides_logger_ = false;
+
+	/// Following members are guarded by the registry's lock
+
+	bool registered_ = false;
+
+	bool disabled_ = false;
+
+	/// Next registered site, set before this site is registered
+	LogSite* next_ = nullptr;
+};
+
+/// Call visit with every registered LogSite
+void for_each_site (const std::function<void(LogSite&)>& visit);
+
+/// Update the threshold of every registered LogSite
+/// Changes to module levels and the global logger's level call this
+void refresh_sites (void);
+
+/// Set module levels from comma-separated entries of spec, replacing the
+/// previous levels and return true, or return false leaving them unchanged
+/// if spec has an entry that is not a level name or a module=level pair
+/// (e.g.: "info,egrpc=debug,egrpc/server_async=trace")
+/// A LogSite logs at the level of the longest module whose '/'-separated
+/// segments appear in its module name (e.g.: "egrpc" matches sites in
+/// "/src/egrpc/client_async.hpp"), otherwise at the entry without module
+/// if any, otherwise at the global logger's level
+/// The entry without module also sets the level of global log functions
+/// called outside sites (e.g.: logs::debug), and messages enabled by
+/// module levels reach loggers through log_unfiltered, so they are not
+/// dropped by a less verbose logger
+bool set_module_levels (const std::string& spec);
+
+/// Set module levels from environment variable var if it is set
+/// Return false if its value is rejected by set_module_levels
+bool set_module_levels_env (const std::string& var = module_levels_env);
+
+/// Counters of a LogSite deciding which of its messages are logged,
+/// where suppressed messages cost no formatting or locking
+/// Suppressed messages are counted for a summary logged from the site
+/// before its next logged message, or by report_suppressed
+struct SiteSampler final
+{
+	constexpr SiteSampler (LogSite& site) : site_(&site) {}
+
+	SiteSampler (const SiteSampler& other) = delete;
+
+	SiteSampler& operator = (const SiteSampler& other) = delete;
+
+	/// Return true for the first of every n messages,
+	/// where n of 0 suppresses every message
+	bool every_n (size_t n)
+	{
+		if (n == 0 || count_.fetch_add(1, std::memory_order_relaxed) % n != 0)
+		{
+			suppress();
+			return false;
+		}
+		return true;
+	}
+
+	/// Return true for the first n messages
+	bool first_n (size_t n)
+	{
+		if (count_.load(std::memory_order_relaxed) >= n ||
+			count_.fetch_add(1, std::memory_order_relaxed) >= n)
+		{
+			suppress();
+			return false;
+		}
+		return true;
+	}
+
+	/// Return true if a token bucket refilled at per_second tokens per
+	/// second, holding at most burst tokens, has a token to take,
+	/// where per_second of 0 or less suppresses every message
+	bool rate_limit (double per_second, double burst = 1)
+	{
+		if (false == (per_second > 0))
+		{
+			suppress();
+			return false;
+		}
+		int64_t interval = 1e9 / per_second;
+		int64_t tolerance = interval * (std::max(burst, 1.) - 1);
+		int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		// next_ns_ is when the bucket is full again
+		int64_t full = next_ns_.load(std::memory_order_relaxed);
+		while (true)
+		{
+			int64_t start = std::max(full, now);
+			if (start - now > tolerance)
+			{
+				suppress();
+				return false;
+			}
+			if (next_ns_.compare_exchange_weak(full, start + interval,
+				std::memory_order_relaxed))
+			{
+				return true;
+			}
+		}
+	}
+
+	/// Log the number of messages suppressed since the last summary if any,
+	/// unless the site is disabled, in which case the count is kept until
+	/// the site is enabled again
+	void summarize (void)
+	{
+		if (suppressed_.load(std::memory_order_relaxed) > 0 &&
+			site_->enabled())
+		{
+			size_t n = suppressed_.exchange(0, std::memory_order_relaxed);
+			if (n > 0)
+			{
+				LoggerGuard guard;
+				guard.logger().log_unfiltered(site_->level_, fmts::sprintf(
+					"%zu messages suppressed", n), site_->location_);
+			}
+		}
+	}
+
+	LogSite* site_;
+
+private:
+	friend void report_suppressed (void);
+
+	void suppress (void)
+	{
+		suppressed_.fetch_add(1, std::memory_order_relaxed);
+		if (false == registered_.load(std::memory_order_relaxed))
+		{
+			register_sampler();
+		}
+	}
+
+	/// Add this sampler to the samplers visited by report_suppressed
+	void register_sampler (void);
+
+	std::atomic<size_t> count_ = 0;
+
+	std::atomic<int64_t> next_ns_ = 0;
+
+	std::atomic<size_t> suppressed_ = 0;
+
+	std::atomic<bool> registered_ = false;
+
+	/// Next registered sampler, set before this sampler is registered
+	SiteSampler* next_ = nullptr;
+};
+
+/// Summarize every SiteSampler that suppressed messages since its last
+/// summary, call periodically (e.g.: from a jobs::ManagedJob) so sites
+/// that stop logging still report what they suppressed
+void report_suppressed (void);
+
+/// Log at site's level using global logger with arguments of format
+/// that is not a literal (e.g.: std::string or char buffer)
+template <typename FORMAT, typename... ARGS>
+NonLiteralT<FORMAT> sitef (const LogSite& site,
+	FORMAT&& format, ARGS... args)
+{
+	LoggerGuard guard;
+	guard.logger().log_unfiltered(site.level_,
+		fmts::sprintf(format, args...), site.location_);
+}
+
+/// Log at site's level using global logger with arguments of format
+/// literal, which an iDeferLogger records without formatting
+template <typename... ARGS>
+void sitef (const LogSite& site, const FormatLiteral& format, ARGS... args)
+{
+	LoggerGuard guard;
+	if (false == deferf(guard, site.level_, format, args...))
+	{
+		guard.logger().log_unfiltered(site.level_,
+			fmts::sprintf(format.format_, args...), site.location_);
+	}
 }
 
+/// Log at site's level using logger with arguments, for components
+/// that log through a logger of their own instead of the global logger
+/// Sites overriding loggers (see LogSite::overrides_logger) decide
+/// whether the message is logged, otherwise logger decides
+template <typename... ARGS>
+void sitef (iLogger& logger, LogSite& site,
+	const std::string& format, ARGS... args)
+{
+	if (false == site.overrides_logger())
+	{
+		logger.log(site.level_,
+			fmts::sprintf(format, args...), site.location_);
+	}
+	else if (site.enabled())
+	{
+		logger.log_unfiltered(site.level_,
+			fmts::sprintf(format, args...), site.location_);
+	}
+}
+
+}
+
+/// Log message formatted from the printf arguments at enum level
+/// (e.g.: DEBUG) using global logger, from a LogSite at this call
+/// in MODULE (a string literal), where the arguments are neither
+/// evaluated nor formatted unless the site is enabled
+#define LOGS_MODULE_LOGF(MODULE, LEVEL, ...) do {\
+	static ::logs::LogSite logs_site_(::logs::LEVEL, MODULE);\
+	if (logs_site_.enabled()) { ::logs::sitef(logs_site_, __VA_ARGS__); }\
+	} while (false)
+
+/// Log message like LOGS_MODULE_LOGF from a LogSite whose module is
+/// the file of this call
+#define LOGS_LOGF(LEVEL, ...) LOGS_MODULE_LOGF(nullptr, LEVEL, __VA_ARGS__)
+
+/// Log message at enum level using LOGGER (an iLogger reference)
+/// instead of the global logger, from a LogSite whose module is the file
+/// of this call, so module levels matching the file also apply to
+/// components that are given their own logger
+/// LOGGER's own level decides for files no module level matches
+#define LOGS_LOGGER_LOGF(LOGGER, LEVEL, ...) do {\
+	static ::logs::LogSite logs_site_(::logs::LEVEL);\
+	::logs::sitef(LOGGER, logs_site_, __VA_ARGS__);\
+	} while (false)
+
+/// Log message like LOGS_LOGF if the site's SiteSampler method call
+/// SAMPLE (e.g.: every_n(10)) returns true
+#define LOGS_SAMPLED_LOGF(SAMPLE, LEVEL, ...) do {\
+	static ::logs::LogSite logs_site_(::logs::LEVEL);\
+	static ::logs::SiteSampler logs_sampler_(logs_site_);\
+	if (logs_site_.enabled() && logs_sampler_.SAMPLE)\
+	{ logs_sampler_.summarize(); ::logs::sitef(logs_site_, __VA_ARGS__); }\
+	} while (false)
+
+/// Log the first of every N messages like LOGS_LOGF
+#define LOGS_EVERY_N(N, LEVEL, ...)\
+	LOGS_SAMPLED_LOGF(every_n(N), LEVEL, __VA_ARGS__)
+
+/// Log the first N messages like LOGS_LOGF
+#define LOGS_FIRST_N(N, LEVEL, ...)\
+	LOGS_SAMPLED_LOGF(first_n(N), LEVEL, __VA_ARGS__)
+
+/// Log at most PER_SECOND messages per second on average like LOGS_LOGF,
+/// allowing bursts of up to a second's worth of messages
+#define LOGS_RATE_LIMITED(PER_SECOND, LEVEL, ...)\
+	LOGS_SAMPLED_LOGF(rate_limit(PER_SECOND, PER_SECOND), LEVEL, __VA_ARGS__)
+
 #endif // PKG_LOGS_HPP
@@ -0,0 +1,299 @@
+///
+/// sink.hpp
+/// logs
+///
+/// Purpose:
+/// Define destinations of log output and per-thread buffers
+/// that write to them in batches
+///
+
+#ifndef PKG_LOGS_SINK_HPP
+#define PKG_LOGS_SINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace logs
+{
+
+/// Destination of batches of log bytes
+struct iSink
+{
+	virtual ~iSink (void) = default;
+
+	/// Write n bytes of data, callers never write concurrently
+	virtual void write (const char* data, size_t n) = 0;
+
+	/// Return the epoch the next write of n bytes lands in, after moving
+	/// on to a new destination if that write would (e.g.: rotating files)
+	/// Bytes written in an epoch are read without those of earlier epochs
+	virtual size_t begin_write (size_t /*n*/)
+	{
+		return 0;
+	}
+};
+
+/// Sink that writes batches to an output stream
+struct StreamSink final : public iSink
+{
+	StreamSink (std::ostream& out) : out_(out) {}
+
+	/// Implementation of iSink
+	void write (const char* data, size_t n) override
+	{
+		out_.write(data, n);
+		out_.flush();
+	}
+
+private:
+	std::ostream& out_;
+};
+
+/// Sink that writes each batch to a file descriptor with one write(2)
+/// unless the write is partial or interrupted
+/// Bytes the descriptor fails to take are dropped
+struct FdSink final : public iSink
+{
+	/// Close fd on destruction if owned
+	FdSink (int fd, bool owned = false) : fd_(fd), owned_(owned) {}
+
+	~FdSink (void);
+
+	FdSink (const FdSink& other) = delete;
+
+	FdSink& operator = (const FdSink& other) = delete;
+
+	/// Implementation of iSink
+	void write (const char* data, size_t n) override;
+
+private:
+	int fd_;
+
+	bool owned_;
+};
+
+/// Sink that appends to the file at path, and once a batch would grow
+/// the file beyond max_size, renames it to path.1 (path.1 to path.2 and
+/// so on, keeping nkept renamed files) before starting a new file at path
+struct RotatingFileSink final : public iSink
+{
+	/// Throw std::runtime_error if path cannot be opened
+	RotatingFileSink (const std::string& path, size_t max_size,
+		size_t nkept = 1);
+
+	~RotatingFileSink (void);
+
+	RotatingFileSink (const RotatingFileSink& other) = delete;
+
+	RotatingFileSink& operator = (const RotatingFileSink& other) = delete;
+
+	/// Implementation of iSink
+	void write (const char* data, size_t n) override;
+
+	/// Implementation of iSink
+	/// Each rotation starts a new epoch
+	size_t begin_write (size_t n) override;
+
+private:
+	void open (void);
+
+	void rotate (void);
+
+	std::string path_;
+
+	size_t max_size_;
+
+	size_t nkept_;
+
+	int fd_ = -1;
+
+	size_t size_ = 0;
+
+	size_t epoch_ = 0;
+};
+
+/// Default size in bytes at which a thread's buffer is written as a batch
+const size_t batch_flush_size = 1 << 16;
+
+/// Default age at which a thread's buffer is written as a batch
+/// when the thread next appends to it
+const std::chrono::milliseconds batch_flush_interval(100);
+
+/// Per-thread state of ThreadBatcher buffers that need none
+struct NoBatchState final {};
+
+/// Per-thread append buffers, each holding STATE for its thread,
+/// that are written to a sink as a batch once they reach a flush size,
+/// or once they are older than a flush interval when next released
+/// Batches that later batches depend on through STATE (e.g.: definitions
+/// the thread no longer repeats) are restated before the first batch
+/// each buffer writes in a new sink epoch
+template <typename STATE = NoBatchState>
+struct ThreadBatcher final
+{
+	using ClockT = std::chrono::steady_clock;
+
+	/// Append bytes restating a thread's STATE to a batch
+	using RestateF = std::function<void(const STATE&,std::string&)>;
+
+	struct Buffer final
+	{
+		/// Held by the owning thread between acquire and release
+		std::mutex mtx_;
+
+		std::string data_;
+
+		STATE state_;
+
+		ClockT::time_point flushed_ = ClockT::now();
+
+		/// Sink epoch of the last batch written (guarded by sink_mtx_)
+		size_t epoch_ = 0;
+	};
+
+	/// A zero flush_interval only writes by size and by flush
+	ThreadBatcher (std::shared_ptr<iSink> sink,
+		size_t flush_size = batch_flush_size,
+		std::chrono::milliseconds flush_interval = batch_flush_interval,
+		RestateF restate = RestateF()) :
+		id_(next_id().fetch_add(1)), sink_(sink),
+		flush_size_(flush_size), flush_interval_(flush_interval),
+		restate_(restate) {}
+
+	~ThreadBatcher (void)
+	{
+		flush();
+	}
+
+	ThreadBatcher (const ThreadBatcher<STATE>& other) = delete;
+
+	ThreadBatcher<STATE>& operator = (
+		const ThreadBatcher<STATE>& other) = delete;
+
+	/// Return the calling thread's buffer
+	Buffer& local (void)
+	{
+		// buffers outlive their thread in buffers_ and their batcher here,
+		// so neither has to outlive the other
+		thread_local std::unordered_map<size_t,
+			std::shared_ptr<Buffer>> buffers;
+		thread_local size_t last_id = std::numeric_limits<size_t>::max();
+		thread_local Buffer* last_buffer = nullptr;
+		if (last_id != id_)
+		{
+			auto& buffer = buffers[id_];
+			if (nullptr == buffer)
+			{
+				buffer = std::make_shared<Buffer>();
+				std::lock_guard<std::mutex> guard(sink_mtx_);
+				buffers_.push_back(buffer);
+			}
+			last_id = id_;
+			last_buffer = buffer.get();
+		}
+		return *last_buffer;
+	}
+
+	/// Return the calling thread's buffer locked for appending
+	/// Callers must release it
+	Buffer& acquire (void)
+	{
+		Buffer& buffer = local();
+		buffer.mtx_.lock();
+		return buffer;
+	}
+
+	/// Unlock the buffer acquired by the calling thread, and write it
+	/// as a batch if it reached the flush size or interval
+	void release (Buffer& buffer)
+	{
+		auto now = flush_interval_.count() > 0 ?
+			ClockT::now() : ClockT::time_point();
+		if (buffer.data_.size() < flush_size_ &&
+			(flush_interval_.count() == 0 ||
+			now - buffer.flushed_ < flush_interval_))
+		{
+			buffer.mtx_.unlock();
+			return;
+		}
+		std::string batch;
+		std::swap(batch, buffer.data_);
+		buffer.flushed_ = now;
+		buffer.mtx_.unlock();
+
+		// only this thread appends to buffer, so flush cannot write
+		// anything appended after batch before batch is written
+		std::lock_guard<std::mutex> guard(sink_mtx_);
+		write_batch(buffer, batch);
+	}
+
+	/// Write every thread's buffer to the sink
+	void flush (void)
+	{
+		std::lock_guard<std::mutex> guard(sink_mtx_);
+		for (auto& buffer : buffers_)
+		{
+			std::lock_guard<std::mutex> bguard(buffer->mtx_);
+			if (buffer->data_.size() > 0)
+			{
+				write_batch(*buffer, buffer->data_);
+				buffer->data_.clear();
+			}
+			buffer->flushed_ = ClockT::now();
+		}
+	}
+
+private:
+	/// Write batch of buffer to the sink, after restating buffer's state
+	/// if the batch lands in a new epoch, sink_mtx_ must be held
+	void write_batch (Buffer& buffer, const std::string& batch)
+	{
+		size_t epoch = sink_->begin_write(batch.size());
+		if (epoch == buffer.epoch_ || false == bool(restate_))
+		{
+			buffer.epoch_ = epoch;
+			sink_->write(batch.data(), batch.size());
+			return;
+		}
+		// written at once, so the batch lands in the epoch of its restatement
+		std::string restated;
+		restate_(buffer.state_, restated);
+		restated.append(batch);
+		buffer.epoch_ = sink_->begin_write(restated.size());
+		sink_->write(restated.data(), restated.size());
+	}
+
+	static std::atomic<size_t>& next_id (void)
+	{
+		static std::atomic<size_t> id = 0;
+		return id;
+	}
+
+	/// Identifies this batcher's buffers in each thread
+	size_t id_;
+
+	std::shared_ptr<iSink> sink_;
+
+	size_t flush_size_;
+
+	std::chrono::milliseconds flush_interval_;
+
+	RestateF restate_;
+
+	/// Guards sink_ and buffers_, taken before any Buffer::mtx_
+	std::mutex sink_mtx_;
+
+	std::vector<std::shared_ptr<Buffer>> buffers_;
+};
+
+}
+
+#endif // PKG_LOGS_SINK_HPP
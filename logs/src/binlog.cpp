@@ -0,0 +1,405 @@
+#include "logs/logs.hpp"
+
+#ifdef PKG_LOGS_BINLOG_HPP
+
+#include <cctype>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace logs
+{
+
+/// Append FORMAT_RECORD defining format (or file) to records
+static void append_format (std::string& records, const char* format)
+{
+	uint32_t n = std::strlen(format);
+	records.push_back(FORMAT_RECORD);
+	append_raw(records, static_cast<uint64_t>(
+		reinterpret_cast<uintptr_t>(format)));
+	append_raw(records, n);
+	records.append(format, n);
+}
+
+BinaryLogger::BinaryLogger (std::shared_ptr<iSink> sink, size_t flush_size,
+	std::chrono::milliseconds flush_interval) :
+	log_level_(INFO), batcher_(sink, flush_size, flush_interval,
+	[](const FormatsT& formats, std::string& records)
+	{
+		// formats and files defined in files rotated away are redefined
+		for (const char* format : formats)
+		{
+			append_format(records, format);
+		}
+	}) {}
+
+std::string BinaryLogger::get_log_level (void) const
+{
+	return name_log((LOG_LEVEL) log_level_.load());
+}
+
+void BinaryLogger::set_log_level (const std::string& log_level)
+{
+	auto it = names2log.find(log_level);
+	if (names2log.end() != it)
+	{
+		log_level_ = it->second;
+		sync_log_level(*this);
+	}
+}
+
+bool BinaryLogger::supports_level (size_t msg_level) const
+{
+	return msg_level < NOT_SET;
+}
+
+bool BinaryLogger::supports_level (const std::string& msg_level) const
+{
+	return names2log.end() != names2log.find(msg_level);
+}
+
+void BinaryLogger::log (size_t msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	if (msg_level <= log_level_.load(std::memory_order_relaxed))
+	{
+		log_unfiltered(msg_level, msg, location);
+	}
+}
+
+void BinaryLogger::log_unfiltered (size_t msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	const char* file = location.file_name();
+	uint32_t nfile = std::strlen(file);
+	auto& buffer = batcher_.acquire();
+	buffer.data_.push_back(TEXT_RECORD);
+	buffer.data_.push_back(static_cast<char>(msg_level));
+	append_raw(buffer.data_, static_cast<uint32_t>(location.line()));
+	append_raw(buffer.data_, nfile);
+	buffer.data_.append(file, nfile);
+	append_raw(buffer.data_, static_cast<uint32_t>(msg.size()));
+	buffer.data_.append(msg);
+	batcher_.release(buffer);
+	if (msg_level == FATAL)
+	{
+		flush();
+		throw std::runtime_error(msg);
+	}
+}
+
+void BinaryLogger::log (const std::string& msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	LOG_LEVEL level = TRACE;
+	auto it = names2log.find(msg_level);
+	if (names2log.end() != it)
+	{
+		level = it->second;
+	}
+	log(level, msg, location);
+}
+
+/// Return id of str after appending its FORMAT_RECORD to records
+/// unless formats already holds it
+static uint64_t define_format (std::string& records,
+	std::unordered_set<const char*>& formats, const char* str)
+{
+	if (formats.emplace(str).second)
+	{
+		append_format(records, str);
+	}
+	return reinterpret_cast<uintptr_t>(str);
+}
+
+std::string* BinaryLogger::begin_record (size_t msg_level,
+	const FormatLiteral& format, uint8_t nargs, bool unfiltered)
+{
+	if (false == unfiltered &&
+		msg_level > log_level_.load(std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	auto& buffer = batcher_.acquire();
+	std::string& records = buffer.data_;
+	// file names of locations are literals like formats
+	uint64_t file = define_format(records, buffer.state_,
+		format.location_.file_name());
+	uint64_t id = define_format(records, buffer.state_, format.format_);
+	records.push_back(DEFERRED_RECORD);
+	records.push_back(static_cast<char>(msg_level));
+	append_raw(records, file);
+	append_raw(records, static_cast<uint32_t>(format.location_.line()));
+	append_raw(records, id);
+	records.push_back(static_cast<char>(nargs));
+	return &records;
+}
+
+void BinaryLogger::end_record (void)
+{
+	batcher_.release(batcher_.local());
+}
+
+void BinaryLogger::flush (void)
+{
+	batcher_.flush();
+}
+
+/// printf argument of a deferred record
+struct BinArg final
+{
+	ArgTag tag_;
+
+	uint64_t bits_;
+
+	std::string str_;
+
+	long long as_int (void) const
+	{
+		if (tag_ == FLOAT_ARG)
+		{
+			double d;
+			std::memcpy(&d, &bits_, sizeof(d));
+			return d;
+		}
+		return bits_;
+	}
+
+	double as_float (void) const
+	{
+		switch (tag_)
+		{
+			case FLOAT_ARG:
+			{
+				double d;
+				std::memcpy(&d, &bits_, sizeof(d));
+				return d;
+			}
+			case INT_ARG:
+				return static_cast<int64_t>(bits_);
+			default:
+				return bits_;
+		}
+	}
+};
+
+template <typename T>
+static T read_raw (std::istream& in)
+{
+	T value;
+	if (false == in.read(reinterpret_cast<char*>(&value), sizeof(T)).good())
+	{
+		throw std::runtime_error("truncated binary log record");
+	}
+	return value;
+}
+
+static std::string read_str (std::istream& in)
+{
+	std::string str(read_raw<uint32_t>(in), '\0');
+	if (str.size() > 0 && false == in.read(&str[0], str.size()).good())
+	{
+		throw std::runtime_error("truncated binary log string");
+	}
+	return str;
+}
+
+/// Return format with printf conversions replaced by the text of args
+static std::string render_format (const std::string& format,
+	const std::vector<BinArg>& args)
+{
+	static const std::string flag_chars = "-+ #0'";
+	static const std::string length_chars = "hlLqjzt";
+	std::string out;
+	size_t iarg = 0;
+	auto next_arg = [&]() -> const BinArg*
+	{
+		return iarg < args.size() ? &args[iarg++] : nullptr;
+	};
+	for (size_t i = 0, n = format.size(); i < n; ++i)
+	{
+		if (format[i] != '%')
+		{
+			out.push_back(format[i]);
+			continue;
+		}
+		if (i + 1 < n && format[i + 1] == '%')
+		{
+			out.push_back('%');
+			++i;
+			continue;
+		}
+		// rebuild the conversion without length modifiers,
+		// with * replaced by the argument value
+		std::string spec = "%";
+		size_t start = i;
+		size_t j = i + 1;
+		for (; j < n && flag_chars.find(format[j]) != std::string::npos; ++j)
+		{
+			spec.push_back(format[j]);
+		}
+		bool precision = false;
+		for (; j < n; ++j)
+		{
+			char c = format[j];
+			if (c == '*')
+			{
+				const BinArg* arg = next_arg();
+				spec += std::to_string(nullptr == arg ? 0 : arg->as_int());
+			}
+			else if (std::isdigit(c) || (c == '.' && false == precision))
+			{
+				precision = precision || c == '.';
+				spec.push_back(c);
+			}
+			else
+			{
+				break;
+			}
+		}
+		for (; j < n && length_chars.find(format[j]) != std::string::npos; ++j);
+		if (j >= n)
+		{
+			out += format.substr(i);
+			break;
+		}
+		char conv = format[j];
+		i = j;
+		if (conv == 'n')
+		{
+			next_arg();
+			continue;
+		}
+		const BinArg* arg = next_arg();
+		if (nullptr == arg)
+		{
+			out += "(missing)";
+			continue;
+		}
+		switch (conv)
+		{
+			case 'd':
+			case 'i':
+				out += fmts::sprintf(spec + "ll" + conv, arg->as_int());
+				break;
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+				out += fmts::sprintf(spec + "ll" + conv,
+					static_cast<unsigned long long>(arg->as_int()));
+				break;
+			case 'c':
+				out += fmts::sprintf(spec + conv,
+					static_cast<int>(arg->as_int()));
+				break;
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				out += fmts::sprintf(spec + conv, arg->as_float());
+				break;
+			case 's':
+				out += arg->tag_ == STR_ARG ?
+					fmts::sprintf(spec + conv, arg->str_.c_str()) :
+					"(not a string)";
+				break;
+			case 'p':
+				out += fmts::sprintf(spec + conv,
+					reinterpret_cast<void*>(static_cast<uintptr_t>(arg->bits_)));
+				break;
+			default:
+				out += format.substr(start, j - start + 1);
+		}
+	}
+	return out;
+}
+
+static void write_line (std::ostream& out, uint8_t level, const std::string& msg)
+{
+	out << name_log(static_cast<LOG_LEVEL>(level)) << ":" << msg << '\n';
+}
+
+using FormatMapT = std::unordered_map<uint64_t,std::string>;
+
+/// Return iterator to the string defined for id in formats
+/// Throw std::runtime_error if it is undefined
+static FormatMapT::const_iterator find_format (
+	const FormatMapT& formats, uint64_t id)
+{
+	auto it = formats.find(id);
+	if (formats.end() == it)
+	{
+		throw std::runtime_error(fmts::sprintf(
+			"binary log record uses undefined format %llu",
+			static_cast<unsigned long long>(id)));
+	}
+	return it;
+}
+
+void decode_binlog (std::ostream& out, std::istream& in)
+{
+	FormatMapT formats;
+	for (int tag = in.get(); tag != std::istream::traits_type::eof();
+		tag = in.get())
+	{
+		switch (tag)
+		{
+			case FORMAT_RECORD:
+			{
+				uint64_t id = read_raw<uint64_t>(in);
+				formats[id] = read_str(in);
+				break;
+			}
+			case DEFERRED_RECORD:
+			{
+				uint8_t level = read_raw<uint8_t>(in);
+				auto file = find_format(formats, read_raw<uint64_t>(in));
+				uint32_t line = read_raw<uint32_t>(in);
+				auto it = find_format(formats, read_raw<uint64_t>(in));
+				uint8_t nargs = read_raw<uint8_t>(in);
+				std::vector<BinArg> args(nargs);
+				for (BinArg& arg : args)
+				{
+					arg.tag_ = static_cast<ArgTag>(read_raw<uint8_t>(in));
+					if (arg.tag_ == STR_ARG)
+					{
+						arg.str_ = read_str(in);
+					}
+					else if (arg.tag_ <= PTR_ARG)
+					{
+						arg.bits_ = read_raw<uint64_t>(in);
+					}
+					else
+					{
+						throw std::runtime_error(fmts::sprintf(
+							"unknown binary log argument tag %d", arg.tag_));
+					}
+				}
+				write_line(out, level, fmts::sprintf("%s:%u-%s",
+					file->second.c_str(), line,
+					render_format(it->second, args).c_str()));
+				break;
+			}
+			case TEXT_RECORD:
+			{
+				uint8_t level = read_raw<uint8_t>(in);
+				uint32_t line = read_raw<uint32_t>(in);
+				std::string file = read_str(in);
+				write_line(out, level, fmts::sprintf("%s:%u-%s",
+					file.c_str(), line, read_str(in).c_str()));
+				break;
+			}
+			default:
+				throw std::runtime_error(fmts::sprintf(
+					"unknown binary log record tag %d", tag));
+		}
+	}
+}
+
+}
+
+#endif
@@ -1,11 +1,127 @@
 #include "logs/logs.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
+#include <string_view>
+#include <thread>
 
 #ifdef PKG_LOGS_HPP
 
 namespace logs
 {
 
-static std::shared_ptr<iLogger> glogger = std::make_shared<DefLogger>();
+/// Global logger as read by LoggerGuards, replaced but never modified
+struct LoggerRecord final
+{
+	std::shared_ptr<iLogger> logger_;
+
+	iDeferLogger* defer_;
+};
+
+/// Epoch of the LoggerGuard a thread is in, threads reuse the slots
+/// of exited threads, so slots are never freed
+struct ReaderSlot final
+{
+	/// Global epoch when the outermost section began, 0 outside sections
+	std::atomic<uint64_t> epoch_ = 0;
+
+	std::atomic<bool> used_ = true;
+
+	/// Number of nested sections, only accessed by the owning thread
+	size_t depth_ = 0;
+
+	/// Next slot, set before this slot is added
+	ReaderSlot* next_ = nullptr;
+};
+
+static std::atomic<LoggerRecord*> grecord = new LoggerRecord{
+	std::make_shared<DefLogger>(), nullptr};
+
+static std::atomic<uint64_t> global_epoch = 1;
+
+static std::atomic<ReaderSlot*> slot_head = nullptr;
+
+/// Serializes set_logger, and guards retired_records
+static std::mutex swap_mtx;
+
+/// Replaced records that readers may still hold
+static std::vector<LoggerRecord*> retired_records;
+
+/// Releases the global logger at exit, as its shared_ptr did
+static struct RecordReleaser final
+{
+	~RecordReleaser (void)
+	{
+		std::lock_guard<std::mutex> guard(swap_mtx);
+		delete grecord.exchange(nullptr);
+		for (LoggerRecord* record : retired_records)
+		{
+			delete record;
+		}
+		retired_records.clear();
+	}
+} record_releaser;
+
+/// Return the calling thread's slot, claiming one on first call
+static ReaderSlot& local_slot (void)
+{
+	struct SlotOwner final
+	{
+		SlotOwner (void)
+		{
+			for (slot_ = slot_head.load(std::memory_order_acquire);
+				nullptr != slot_; slot_ = slot_->next_)
+			{
+				bool used = false;
+				if (false == slot_->used_.load(std::memory_order_relaxed) &&
+					slot_->used_.compare_exchange_strong(used, true,
+						std::memory_order_acquire))
+				{
+					return;
+				}
+			}
+			// seq_cst orders adding the slot before its first section reads
+			// the record, so set_logger either visits this slot or this
+			// slot's sections see its record
+			slot_ = new ReaderSlot();
+			slot_->next_ = slot_head.load(std::memory_order_relaxed);
+			while (false == slot_head.compare_exchange_weak(slot_->next_, slot_,
+				std::memory_order_seq_cst, std::memory_order_relaxed));
+		}
+
+		~SlotOwner (void)
+		{
+			slot_->used_.store(false, std::memory_order_release);
+		}
+
+		ReaderSlot* slot_;
+	};
+	thread_local SlotOwner owner;
+	return *owner.slot_;
+}
+
+LoggerGuard::LoggerGuard (void) : slot_(&local_slot())
+{
+	// seq_cst orders publishing the epoch before reading the record,
+	// so set_logger either sees this section or this section sees its record
+	if (slot_->depth_++ == 0)
+	{
+		slot_->epoch_.store(global_epoch.load());
+	}
+	LoggerRecord* record = grecord.load();
+	logger_ = record->logger_.get();
+	defer_ = record->defer_;
+}
+
+LoggerGuard::~LoggerGuard (void)
+{
+	if (--slot_->depth_ == 0)
+	{
+		slot_->epoch_.store(0, std::memory_order_release);
+	}
+}
+
+std::atomic<size_t> global_log_level = INFO;
 
 std::string name_log (const LOG_LEVEL& level)
 {
@@ -26,54 +142,316 @@ LOG_LEVEL enum_log (const std::string& level)
 	return names2log.at(level);
 }
 
+LOG_LEVEL enum_log_nocase (const std::string& level)
+{
+	for (size_t i = 0, n = lognames.size(); i < n; ++i)
+	{
+		const std::string& name = lognames[i];
+		if (name.size() == level.size() && std::equal(
+			name.begin(), name.end(), level.begin(),
+			[](char l, unsigned char r){ return l == std::tolower(r); }))
+		{
+			return (LOG_LEVEL) i;
+		}
+	}
+	return NOT_SET;
+}
+
+/// Return level to cache for logger
+static size_t cached_log_level (const iLogger* logger)
+{
+	if (nullptr == logger || false == logger->syncs_log_level())
+	{
+		return NOT_SET;
+	}
+	return enum_log(logger->get_log_level());
+}
+
+/// Set the global logger's cached level, from which global_log_level
+/// and site thresholds are resolved with module levels
+static void update_log_levels (size_t logger_level);
+
+void sync_log_level (const iLogger& logger)
+{
+	LoggerGuard guard;
+	if (grecord.load()->logger_.get() == &logger)
+	{
+		update_log_levels(cached_log_level(&logger));
+	}
+}
+
 void set_logger (std::shared_ptr<iLogger> logger)
 {
-	glogger = logger;
+	std::lock_guard<std::mutex> guard(swap_mtx);
+	retired_records.push_back(grecord.exchange(new LoggerRecord{
+		logger, dynamic_cast<iDeferLogger*>(logger.get())}));
+	update_log_levels(cached_log_level(logger.get()));
+
+	// sections that began before this epoch may hold retired records,
+	// the calling thread's section never ends while it waits
+	uint64_t epoch = global_epoch.fetch_add(1) + 1;
+	if (local_slot().depth_ > 0)
+	{
+		return;
+	}
+	for (ReaderSlot* slot = slot_head.load();
+		nullptr != slot; slot = slot->next_)
+	{
+		for (uint64_t begun = slot->epoch_.load();
+			begun != 0 && begun < epoch; begun = slot->epoch_.load())
+		{
+			std::this_thread::yield();
+		}
+	}
+	for (LoggerRecord* record : retired_records)
+	{
+		delete record;
+	}
+	retired_records.clear();
 }
 
 iLogger& get_logger (void)
 {
-	return *glogger;
+	return *grecord.load()->logger_;
 }
 
 std::string get_log_level (void)
 {
-	return get_logger().get_log_level();
+	return LoggerGuard().logger().get_log_level();
 }
 
 void set_log_level (const std::string& log_level)
 {
-	get_logger().set_log_level(log_level);
+	LoggerGuard guard;
+	guard.logger().set_log_level(log_level);
+	sync_log_level(guard.logger());
 }
 
-void trace (const std::string& msg)
+void trace (const std::string& msg, const SrcLocT& location)
 {
-	get_logger().log(TRACE, msg);
+	if (log_enabled(TRACE))
+	{
+		LoggerGuard().logger().log_unfiltered(TRACE, msg, location);
+	}
 }
 
-void debug (const std::string& msg)
+void debug (const std::string& msg, const SrcLocT& location)
 {
-	get_logger().log(DEBUG, msg);
+	if (log_enabled(DEBUG))
+	{
+		LoggerGuard().logger().log_unfiltered(DEBUG, msg, location);
+	}
 }
 
-void info (const std::string& msg)
+void info (const std::string& msg, const SrcLocT& location)
 {
-	get_logger().log(INFO, msg);
+	if (log_enabled(INFO))
+	{
+		LoggerGuard().logger().log_unfiltered(INFO, msg, location);
+	}
 }
 
-void warn (const std::string& msg)
+void warn (const std::string& msg, const SrcLocT& location)
 {
-	get_logger().log(WARN, msg);
+	if (log_enabled(WARN))
+	{
+		LoggerGuard().logger().log_unfiltered(WARN, msg, location);
+	}
 }
 
-void error (const std::string& msg)
+void error (const std::string& msg, const SrcLocT& location)
 {
-	get_logger().log(ERROR, msg);
+	if (log_enabled(ERROR))
+	{
+		LoggerGuard().logger().log_unfiltered(ERROR, msg, location);
+	}
+}
+
+void fatal (const std::string& msg, const SrcLocT& location)
+{
+	LoggerGuard().logger().log_unfiltered(FATAL, msg, location);
+}
+
+static std::atomic<LogSite*> site_head = nullptr;
+
+/// Guards registration and thresholds of sites, and module levels
+static std::mutex site_mtx;
+
+using ModuleLevelsT = std::vector<std::pair<std::string,size_t>>;
+
+static ModuleLevelsT module_levels;
+
+/// Level of messages matching no module, NOT_SET + 1 if unset
+static size_t default_module_level = NOT_SET + 1;
+
+/// Cached level of the global logger
+static size_t logger_log_level = INFO;
+
+/// Return true if the '/'-separated segments of module appear in name
+static bool match_module (const std::string& module, std::string_view name)
+{
+	for (size_t i = name.find(module); i != std::string_view::npos;
+		i = name.find(module, i + 1))
+	{
+		size_t end = i + module.size();
+		if ((i == 0 || name[i - 1] == '/') && (end == name.size() ||
+			name[end] == '/' || name[end] == '.'))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void LogSite::resolve (size_t global_level)
+{
+	if (disabled_)
+	{
+		threshold_.store(0, std::memory_order_relaxed);
+		overrides_logger_.store(true, std::memory_order_relaxed);
+		return;
+	}
+	size_t level = global_level;
+	size_t matched = 0;
+	std::string_view name = module_name();
+	for (auto& module_level : module_levels)
+	{
+		if (module_level.first.size() >= matched &&
+			match_module(module_level.first, name))
+		{
+			level = module_level.second;
+			matched = module_level.first.size();
+		}
+	}
+	overrides_logger_.store(matched > 0, std::memory_order_relaxed);
+	threshold_.store(level + 1, std::memory_order_relaxed);
+}
+
+uint8_t LogSite::register_site (void)
+{
+	std::lock_guard<std::mutex> guard(site_mtx);
+	if (false == registered_)
+	{
+		registered_ = true;
+		next_ = site_head.load(std::memory_order_relaxed);
+		site_head.store(this, std::memory_order_release);
+		resolve(global_log_level.load());
+	}
+	return threshold_.load(std::memory_order_relaxed);
+}
+
+void LogSite::set_enabled (bool enabled)
+{
+	register_site();
+	std::lock_guard<std::mutex> guard(site_mtx);
+	disabled_ = false == enabled;
+	resolve(global_log_level.load());
+}
+
+void for_each_site (const std::function<void(LogSite&)>& visit)
+{
+	for (LogSite* site = site_head.load(std::memory_order_acquire);
+		nullptr != site; site = site->next_)
+	{
+		visit(*site);
+	}
+}
+
+static void update_log_levels (size_t logger_level)
+{
+	{
+		std::lock_guard<std::mutex> guard(site_mtx);
+		logger_log_level = logger_level;
+	}
+	refresh_sites();
+}
+
+void refresh_sites (void)
+{
+	std::lock_guard<std::mutex> guard(site_mtx);
+	// the entry without module overrides the global logger's level
+	size_t global_level = default_module_level <= NOT_SET ?
+		default_module_level : logger_log_level;
+	global_log_level.store(global_level, std::memory_order_relaxed);
+	for (LogSite* site = site_head.load(std::memory_order_acquire);
+		nullptr != site; site = site->next_)
+	{
+		site->resolve(global_level);
+	}
+}
+
+bool set_module_levels (const std::string& spec)
+{
+	ModuleLevelsT levels;
+	size_t default_level = NOT_SET + 1;
+	std::stringstream entries(spec);
+	std::string entry;
+	while (std::getline(entries, entry, ','))
+	{
+		fmts::trim(entry);
+		if (entry.empty())
+		{
+			continue;
+		}
+		size_t eq = entry.find('=');
+		std::string module;
+		std::string level_name = entry;
+		if (eq != std::string::npos)
+		{
+			module = entry.substr(0, eq);
+			level_name = entry.substr(eq + 1);
+			fmts::trim(module);
+			fmts::trim(level_name);
+		}
+		LOG_LEVEL level = enum_log_nocase(level_name);
+		if (NOT_SET == level || (eq != std::string::npos && module.empty()))
+		{
+			return false;
+		}
+		if (eq == std::string::npos)
+		{
+			default_level = level;
+		}
+		else
+		{
+			levels.push_back({module, level});
+		}
+	}
+	{
+		std::lock_guard<std::mutex> guard(site_mtx);
+		module_levels = std::move(levels);
+		default_module_level = default_level;
+	}
+	refresh_sites();
+	return true;
+}
+
+bool set_module_levels_env (const std::string& var)
+{
+	const char* spec = std::getenv(var.c_str());
+	return nullptr == spec || set_module_levels(spec);
 }
 
-void fatal (const std::string& msg)
+static std::atomic<SiteSampler*> sampler_head = nullptr;
+
+void SiteSampler::register_sampler (void)
+{
+	bool registered = false;
+	if (registered_.compare_exchange_strong(registered, true))
+	{
+		next_ = sampler_head.load(std::memory_order_relaxed);
+		while (false == sampler_head.compare_exchange_weak(next_, this,
+			std::memory_order_release, std::memory_order_relaxed));
+	}
+}
+
+void report_suppressed (void)
 {
-	get_logger().log(FATAL, msg);
+	for (SiteSampler* sampler = sampler_head.load(std::memory_order_acquire);
+		nullptr != sampler; sampler = sampler->next_)
+	{
+		sampler->summarize();
+	}
 }
 
 }
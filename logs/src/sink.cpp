@@ -0,0 +1,202 @@
+#include "logs/logs.hpp"
+
+#ifdef PKG_LOGS_SINK_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace logs
+{
+
+/// Write n bytes of data to fd, retrying partial and interrupted writes,
+/// return false if fd fails to take them
+static bool write_all (int fd, const char* data, size_t n)
+{
+	while (n > 0)
+	{
+		ssize_t written = ::write(fd, data, n);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		n -= written;
+	}
+	return true;
+}
+
+FdSink::~FdSink (void)
+{
+	if (owned_)
+	{
+		::close(fd_);
+	}
+}
+
+void FdSink::write (const char* data, size_t n)
+{
+	write_all(fd_, data, n);
+}
+
+RotatingFileSink::RotatingFileSink (const std::string& path,
+	size_t max_size, size_t nkept) :
+	path_(path), max_size_(max_size), nkept_(nkept)
+{
+	open();
+}
+
+RotatingFileSink::~RotatingFileSink (void)
+{
+	::close(fd_);
+}
+
+void RotatingFileSink::write (const char* data, size_t n)
+{
+	begin_write(n);
+	if (write_all(fd_, data, n))
+	{
+		size_ += n;
+	}
+}
+
+size_t RotatingFileSink::begin_write (size_t n)
+{
+	if (size_ > 0 && size_ + n > max_size_)
+	{
+		rotate();
+		++epoch_;
+	}
+	return epoch_;
+}
+
+void RotatingFileSink::open (void)
+{
+	fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	struct stat st;
+	if (fd_ < 0 || ::fstat(fd_, &st) < 0)
+	{
+		int err = errno;
+		if (fd_ >= 0)
+		{
+			::close(fd_);
+		}
+		throw std::runtime_error(fmts::sprintf(
+			"failed to open log file %s: %s", path_.c_str(), std::strerror(err)));
+	}
+	size_ = st.st_size;
+}
+
+void RotatingFileSink::rotate (void)
+{
+	::close(fd_);
+	if (nkept_ > 0)
+	{
+		// renaming from the oldest replaces the file beyond nkept
+		for (size_t i = nkept_ - 1; i > 0; --i)
+		{
+			std::string from = fmts::sprintf("%s.%zu", path_.c_str(), i);
+			std::string to = fmts::sprintf("%s.%zu", path_.c_str(), i + 1);
+			::rename(from.c_str(), to.c_str());
+		}
+		::rename(path_.c_str(), (path_ + ".1").c_str());
+	}
+	else
+	{
+		::unlink(path_.c_str());
+	}
+	open();
+}
+
+std::string SinkLogger::get_log_level (void) const
+{
+	return name_log((LOG_LEVEL) log_level_.load());
+}
+
+void SinkLogger::set_log_level (const std::string& log_level)
+{
+	auto it = names2log.find(log_level);
+	if (names2log.end() != it)
+	{
+		log_level_ = it->second;
+		sync_log_level(*this);
+	}
+}
+
+bool SinkLogger::supports_level (size_t msg_level) const
+{
+	return msg_level < NOT_SET;
+}
+
+bool SinkLogger::supports_level (const std::string& msg_level) const
+{
+	return NOT_SET != enum_log_nocase(msg_level);
+}
+
+void SinkLogger::log (size_t msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	if (msg_level <= log_level_.load(std::memory_order_relaxed))
+	{
+		log_unfiltered(msg_level, msg, location);
+	}
+}
+
+void SinkLogger::log_unfiltered (size_t msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	auto& buffer = batcher_.acquire();
+	std::string& lines = buffer.data_;
+	switch (msg_level)
+	{
+		case FATAL:
+		case ERROR:
+			lines.append(err_tag);
+			break;
+		case WARN:
+			lines.append(warn_tag);
+			break;
+		default:
+			lines.append(location.file_name());
+			lines.push_back(':');
+			lines.append(std::to_string(location.line()));
+			lines.push_back('-');
+	}
+	lines.append(msg);
+	lines.push_back('\n');
+	batcher_.release(buffer);
+	if (msg_level == FATAL)
+	{
+		flush();
+		throw std::runtime_error(msg);
+	}
+}
+
+void SinkLogger::log (const std::string& msg_level, const std::string& msg,
+	const SrcLocT& location)
+{
+	LOG_LEVEL level = TRACE;
+	auto it = names2log.find(msg_level);
+	if (names2log.end() != it)
+	{
+		level = it->second;
+	}
+	log(level, msg, location);
+}
+
+void SinkLogger::flush (void)
+{
+	batcher_.flush();
+}
+
+}
+
+#endif
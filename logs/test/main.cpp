@@ -1,3 +1,10 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+
 #include "gtest/gtest.h"
 
 #include "logs/logs.hpp"
@@ -297,4 +304,773 @@ TEST(DEFAULT, Conversions)
 }
 
 
+TEST(DEFAULT, LevelCheck)
+{
+	// levels that are not LOG_LEVEL names filter nothing
+	EXPECT_TRUE(logs::log_enabled(logs::TRACE));
+
+	auto logger = std::make_shared<logs::DefLogger>();
+	logs::set_logger(logger);
+	EXPECT_TRUE(logs::log_enabled(logs::INFO));
+	EXPECT_FALSE(logs::log_enabled(logs::DEBUG));
+
+	size_t nevals = 0;
+	auto count = [&nevals]{ return ++nevals; };
+	LOGS_LOGF(DEBUG, "debugging %zu", count());
+	EXPECT_EQ(0, nevals);
+
+	// level set on the global logger directly is seen by the check
+	logger->set_log_level("warn");
+	EXPECT_FALSE(logs::log_enabled(logs::INFO));
+	EXPECT_TRUE(logs::log_enabled(logs::WARN));
+
+	logs::set_log_level("trace");
+	EXPECT_TRUE(logs::log_enabled(logs::TRACE));
+	LOGS_LOGF(TRACE, "tracing %zu", count());
+	EXPECT_EQ(1, nevals);
+
+	// other loggers do not touch the check
+	logs::DefLogger other;
+	other.set_log_level("error");
+	EXPECT_TRUE(logs::log_enabled(logs::TRACE));
+
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	EXPECT_TRUE(logs::log_enabled(logs::TRACE));
+	LOGS_LOGF(DEBUG, "debugging %zu", count());
+	EXPECT_EQ(2, nevals);
+	auto expect = fmts::sprintf("%ddebugging 2", logs::DEBUG);
+	EXPECT_STREQ(expect.c_str(), TestLogger::latest_log_msg_.c_str());
+}
+
+
+/// Logger with LOG_LEVEL names whose level changes without sync_log_level
+struct UnsyncedLogger final : public logs::iLogger
+{
+	std::string get_log_level (void) const override
+	{
+		return logs::name_log(level_);
+	}
+
+	void set_log_level (const std::string& log_level) override {}
+
+	bool supports_level (size_t msg_level) const override
+	{
+		return true;
+	}
+
+	bool supports_level (const std::string& msg_level) const override
+	{
+		return true;
+	}
+
+	void log (size_t msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		if (msg_level <= level_)
+		{
+			msgs_.push_back(msg);
+		}
+	}
+
+	void log (const std::string& msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		log(logs::enum_log(msg_level), msg, location);
+	}
+
+	logs::LOG_LEVEL level_ = logs::INFO;
+
+	types::StringsT msgs_;
+};
+
+
+TEST(DEFAULT, UnsyncedLevel)
+{
+	// loggers that do not sync their level are never filtered by the cache
+	auto logger = std::make_shared<UnsyncedLogger>();
+	logs::set_logger(logger);
+	EXPECT_TRUE(logs::log_enabled(logs::TRACE));
+	logs::debug("dropped by logger");
+	logger->level_ = logs::DEBUG;
+	logs::debug("debug");
+	logs::debugf("debug %d", 2);
+	LOGS_LOGF(DEBUG, "debug %d", 3);
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	EXPECT_EQ((types::StringsT{"debug", "debug 2", "debug 3"}), logger->msgs_);
+}
+
+TEST(DEFAULT, LevelHandle)
+{
+	logs::LevelHandle warn("Warn");
+	EXPECT_EQ(logs::WARN, warn.level_);
+	EXPECT_STREQ("Warn", warn.name_.c_str());
+
+	logs::LevelHandle info(logs::INFO);
+	EXPECT_STREQ("info", info.name_.c_str());
+
+	logs::LevelHandle custom("custom");
+	EXPECT_EQ(logs::NOT_SET, custom.level_);
+
+	logs::DefLogger logger;
+	EXPECT_TRUE(warn.supported_by(logger));
+	EXPECT_TRUE(logger.supports_level("TRACE"));
+	EXPECT_FALSE(custom.supported_by(logger));
+	EXPECT_FALSE(logger.supports_level("trace "));
+
+	logs::LevelHandle debug("DEBUG");
+	debug.log(logs::get_logger(), "debugging handle");
+	auto expect = fmts::sprintf("%ddebugging handle", logs::DEBUG);
+	EXPECT_STREQ(expect.c_str(), TestLogger::latest_log_msg_.c_str());
+}
+
+
+TEST(DEFAULT, LogSites)
+{
+	std::stringstream out;
+	auto logger = std::make_shared<logs::SinkLogger>(
+		std::make_shared<logs::StreamSink>(out), 1);
+	logs::set_logger(logger);
+
+	size_t nevals = 0;
+	auto count = [&nevals]{ return ++nevals; };
+	auto log_site = [&]{ LOGS_LOGF(INFO, "site %zu", count()); };
+	size_t site_line = __LINE__ - 1;
+	log_site();
+	logs::info("plain info");
+	size_t info_line = __LINE__ - 1;
+
+	logs::LogSite* site = nullptr;
+	logs::for_each_site([&](logs::LogSite& s)
+	{
+		if (s.location_.line() == site_line &&
+			std::string(s.location_.file_name()) == __FILE__)
+		{
+			site = &s;
+		}
+	});
+	ASSERT_NE(nullptr, site);
+	EXPECT_EQ(logs::INFO, site->level_);
+	EXPECT_TRUE(site->enabled());
+
+	site->set_enabled(false);
+	log_site();
+	EXPECT_EQ(1, nevals);
+	site->set_enabled(true);
+	log_site();
+	EXPECT_EQ(2, nevals);
+
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	logger->flush();
+	auto expect = fmts::sprintf("%s:%zu-site 1\n%s:%zu-plain info\n"
+		"%s:%zu-site 2\n", __FILE__, site_line, __FILE__, info_line,
+		__FILE__, site_line);
+	EXPECT_STREQ(expect.c_str(), out.str().c_str());
+}
+
+
+TEST(DEFAULT, ModuleLevels)
+{
+	std::stringstream out;
+	auto logger = std::make_shared<logs::SinkLogger>(
+		std::make_shared<logs::StreamSink>(out), 1);
+	logger->set_log_level("info");
+	logs::set_logger(logger);
+
+	auto log_modules = [&]
+	{
+		LOGS_MODULE_LOGF("egrpc/server", DEBUG, "egrpc debug");
+		LOGS_MODULE_LOGF("other", DEBUG, "other debug");
+		LOGS_MODULE_LOGF("a/b/c", INFO, "a/b/c info");
+		LOGS_MODULE_LOGF("a/bc", INFO, "a/bc info");
+		LOGS_LOGF(TRACE, "file trace");
+		logs::debug("plain debug");
+	};
+	auto logged = [&]
+	{
+		std::string lines;
+		std::string line;
+		while (std::getline(out, line))
+		{
+			lines += line.substr(line.find('-') + 1) + ";";
+		}
+		out.clear();
+		return lines;
+	};
+
+	log_modules();
+	EXPECT_STREQ("a/b/c info;a/bc info;", logged().c_str());
+
+	// modules more verbose than the logger still reach it
+	EXPECT_TRUE(logs::set_module_levels(
+		"info, egrpc=debug, a/b=warn, main=trace"));
+	log_modules();
+	EXPECT_STREQ("egrpc debug;a/bc info;file trace;", logged().c_str());
+
+	// rejected levels leave the previous levels
+	EXPECT_FALSE(logs::set_module_levels("egrpc=loud"));
+	EXPECT_FALSE(logs::set_module_levels("=debug"));
+	log_modules();
+	EXPECT_STREQ("egrpc debug;a/bc info;file trace;", logged().c_str());
+
+	setenv(logs::module_levels_env.c_str(), "warn,other=trace", 1);
+	EXPECT_TRUE(logs::set_module_levels_env());
+	unsetenv(logs::module_levels_env.c_str());
+	log_modules();
+	EXPECT_STREQ("other debug;", logged().c_str());
+
+	// the entry without module also applies outside sites
+	EXPECT_TRUE(logs::set_module_levels("debug,a/b=warn"));
+	log_modules();
+	EXPECT_STREQ("egrpc debug;other debug;a/bc info;plain debug;",
+		logged().c_str());
+
+	// sites of a component's own logger follow module levels
+	std::stringstream own_out;
+	logs::SinkLogger own(std::make_shared<logs::StreamSink>(own_out), 1);
+	own.set_log_level("error");
+	EXPECT_TRUE(logs::set_module_levels("info,main=debug"));
+	LOGS_LOGGER_LOGF(own, DEBUG, "own debug");
+	LOGS_LOGGER_LOGF(own, TRACE, "own trace");
+	EXPECT_NE(std::string::npos, own_out.str().find("own debug"));
+	EXPECT_EQ(std::string::npos, own_out.str().find("own trace"));
+
+	// otherwise the component's logger decides
+	EXPECT_TRUE(logs::set_module_levels("warn,other=trace"));
+	LOGS_LOGGER_LOGF(own, INFO, "own info");
+	LOGS_LOGGER_LOGF(own, ERROR, "own error");
+	own.set_log_level("info");
+	LOGS_LOGGER_LOGF(own, INFO, "own second info");
+	own.flush();
+	EXPECT_EQ(std::string::npos, own_out.str().find("own info"));
+	EXPECT_NE(std::string::npos, own_out.str().find("own error"));
+	EXPECT_NE(std::string::npos, own_out.str().find("own second info"));
+
+	// without module levels sites follow the global logger's level
+	EXPECT_TRUE(logs::set_module_levels(""));
+	logger->set_log_level("info");
+	log_modules();
+	EXPECT_STREQ("a/b/c info;a/bc info;", logged().c_str());
+
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+}
+
+
+TEST(DEFAULT, SampledSites)
+{
+	std::stringstream out;
+	auto logger = std::make_shared<logs::SinkLogger>(
+		std::make_shared<logs::StreamSink>(out), 1);
+	logs::set_logger(logger);
+	auto logged = [&]
+	{
+		std::string lines;
+		std::string line;
+		while (std::getline(out, line))
+		{
+			lines += line.substr(line.find('-') + 1) + ";";
+		}
+		out.clear();
+		return lines;
+	};
+
+	size_t nevals = 0;
+	auto count = [&nevals]{ return ++nevals; };
+	for (size_t i = 0; i < 7; ++i)
+	{
+		LOGS_EVERY_N(3, INFO, "every %zu", count());
+	}
+	EXPECT_EQ(3, nevals);
+	EXPECT_STREQ("every 1;2 messages suppressed;every 2;"
+		"2 messages suppressed;every 3;", logged().c_str());
+
+	// samplers without messages to log count every message as suppressed
+	for (size_t i = 0; i < 3; ++i)
+	{
+		LOGS_EVERY_N(0, INFO, "never %zu", count());
+		LOGS_RATE_LIMITED(0, INFO, "never %zu", count());
+	}
+	EXPECT_EQ(3, nevals);
+	EXPECT_STREQ("", logged().c_str());
+	logs::report_suppressed();
+	EXPECT_STREQ("3 messages suppressed;3 messages suppressed;",
+		logged().c_str());
+
+	for (size_t i = 0; i < 5; ++i)
+	{
+		LOGS_FIRST_N(2, INFO, "first %zu", i);
+	}
+	EXPECT_STREQ("first 0;first 1;", logged().c_str());
+	logs::report_suppressed();
+	EXPECT_STREQ("3 messages suppressed;", logged().c_str());
+	logs::report_suppressed();
+	EXPECT_STREQ("", logged().c_str());
+
+	// a token a day, so only the burst is logged
+	for (size_t i = 0; i < 5; ++i)
+	{
+		LOGS_SAMPLED_LOGF(rate_limit(1. / 86400, 2), INFO, "limited %zu", i);
+	}
+	EXPECT_STREQ("limited 0;limited 1;", logged().c_str());
+	logs::report_suppressed();
+	EXPECT_STREQ("3 messages suppressed;", logged().c_str());
+
+	// disabled sites neither sample nor count suppressions
+	for (size_t i = 0; i < 5; ++i)
+	{
+		LOGS_FIRST_N(1, DEBUG, "debug %zu", i);
+	}
+	logs::report_suppressed();
+	EXPECT_STREQ("", logged().c_str());
+
+	// sites disabled after suppressing report once enabled again
+	static logs::LogSite site(logs::INFO);
+	static logs::SiteSampler sampler(site);
+	for (size_t i = 0; i < 4; ++i)
+	{
+		sampler.first_n(1);
+	}
+	site.set_enabled(false);
+	logs::report_suppressed();
+	EXPECT_STREQ("", logged().c_str());
+	site.set_enabled(true);
+	logs::report_suppressed();
+	EXPECT_STREQ("3 messages suppressed;", logged().c_str());
+
+	const size_t nthreads = 4;
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < nthreads; ++i)
+	{
+		threads.push_back(std::thread([]
+		{
+			for (size_t j = 0; j < 1000; ++j)
+			{
+				LOGS_EVERY_N(10, WARN, "threaded");
+			}
+		}));
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	logs::report_suppressed();
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	logger->flush();
+	std::string line;
+	size_t nlines = 0;
+	size_t nsuppressed = 0;
+	while (std::getline(out, line))
+	{
+		size_t n = 0;
+		if (1 == std::sscanf(line.c_str(),
+			"[WARNING]:%zu messages suppressed", &n))
+		{
+			nsuppressed += n;
+			continue;
+		}
+		EXPECT_STREQ("[WARNING]:threaded", line.c_str());
+		++nlines;
+	}
+	EXPECT_EQ(nthreads * 100, nlines);
+	EXPECT_EQ(nthreads * 900, nsuppressed);
+}
+
+
+struct SwapLogger final : public logs::iLogger
+{
+	static std::atomic<size_t> nreleased_;
+
+	~SwapLogger (void)
+	{
+		alive_ = false;
+		nreleased_.fetch_add(1);
+	}
+
+	std::string get_log_level (void) const override
+	{
+		return logs::info_level;
+	}
+
+	void set_log_level (const std::string& log_level) override {}
+
+	bool supports_level (size_t msg_level) const override
+	{
+		return true;
+	}
+
+	bool supports_level (const std::string& msg_level) const override
+	{
+		return true;
+	}
+
+	void log (size_t msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		EXPECT_TRUE(alive_.load());
+		nlogged_.fetch_add(1);
+	}
+
+	void log (const std::string& msg_level, const std::string& msg,
+		const logs::SrcLocT& location = logs::SrcLocT::current()) override
+	{
+		log(logs::enum_log(msg_level), msg, location);
+	}
+
+	std::atomic<bool> alive_ = true;
+
+	std::atomic<size_t> nlogged_ = 0;
+};
+
+std::atomic<size_t> SwapLogger::nreleased_ = 0;
+
+
+TEST(DEFAULT, SwapLogger)
+{
+	SwapLogger::nreleased_ = 0;
+	const size_t nthreads = 4;
+	const size_t nswaps = 200;
+	std::atomic<bool> done = false;
+	std::vector<std::thread> threads;
+	logs::set_logger(std::make_shared<SwapLogger>());
+	for (size_t i = 0; i < nthreads; ++i)
+	{
+		threads.push_back(std::thread([&done]
+		{
+			while (false == done.load())
+			{
+				logs::info("swapping");
+				logs::infof("swapping %d", 1);
+			}
+		}));
+	}
+	for (size_t i = 0; i < nswaps; ++i)
+	{
+		logs::set_logger(std::make_shared<SwapLogger>());
+	}
+	done = true;
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	// replaced loggers are released by the swap replacing them
+	EXPECT_EQ(nswaps, SwapLogger::nreleased_.load());
+
+	// loggers replaced within a section are released by a later swap
+	auto inner = std::make_shared<SwapLogger>();
+	{
+		logs::LoggerGuard guard;
+		logs::set_logger(inner);
+		EXPECT_EQ(nswaps, SwapLogger::nreleased_.load());
+		guard.logger().log(logs::INFO, "still alive");
+		logs::LoggerGuard nested;
+		nested.logger().log(logs::INFO, "swapped");
+	}
+	EXPECT_EQ(1, inner->nlogged_.load());
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	EXPECT_EQ(nswaps + 1, SwapLogger::nreleased_.load());
+	EXPECT_EQ(log_level_ret, logs::get_log_level());
+}
+
+
+TEST(BINARY, Decode)
+{
+	std::stringstream out;
+	auto logger = std::make_shared<logs::BinaryLogger>(
+		std::make_shared<logs::StreamSink>(out), logs::batch_flush_size,
+		std::chrono::milliseconds(0));
+	logs::set_logger(logger);
+	auto at = [](size_t line)
+	{
+		return fmts::sprintf("%s:%zu-", __FILE__, line);
+	};
+
+	size_t apples_line = __LINE__ + 1;
+	logs::infof("%d apples, %5.2f%% of %s at %x", -3, 12.5, "crates", 255u);
+	logs::debugf("disabled %d", 1);
+	size_t warn_line = __LINE__ + 1;
+	logs::warn("plain warning");
+	logs::infof("%-4s|%*d|", "ab", 3, 7L);
+	std::string dynamic = "formatted %d";
+	logs::infof(dynamic, 4);
+	logs::infof("no arguments");
+	// formats that are not literals are never recorded by address,
+	// which later formats may reuse
+	std::string runtime = "first %d";
+	logs::infof(runtime.c_str(), 5);
+	runtime = "other %d";
+	logs::infof(runtime.c_str(), 6);
+	char buffer[] = "buffer %d";
+	logs::infof(buffer, 7);
+	EXPECT_EQ(0, out.str().size());
+
+	size_t fatal_line = __LINE__ + 3;
+	try
+	{
+		logs::fatal("dying");
+		FAIL() << "binary logger failed to throw on fatal";
+	}
+	catch (std::runtime_error& e)
+	{
+		EXPECT_STREQ("dying", e.what());
+	}
+
+	std::stringstream text;
+	logs::decode_binlog(text, out);
+	// text records carry the location of their call
+	types::StringsT lines;
+	std::string line;
+	while (std::getline(text, line))
+	{
+		lines.push_back(line);
+	}
+	ASSERT_EQ(9, lines.size());
+	EXPECT_STREQ(("info:" + at(apples_line) +
+		"-3 apples, 12.50% of crates at ff").c_str(), lines[0].c_str());
+	EXPECT_STREQ(("warn:" + at(warn_line) + "plain warning").c_str(),
+		lines[1].c_str());
+	EXPECT_STREQ(("info:" + at(warn_line + 1) + "ab  |  7|").c_str(),
+		lines[2].c_str());
+	// formatted in levelf, which does not take the caller's location
+	EXPECT_EQ(0, lines[3].find("info:"));
+	EXPECT_STREQ("-formatted 4",
+		lines[3].substr(lines[3].rfind('-')).c_str());
+	EXPECT_STREQ(("info:" + at(warn_line + 4) + "no arguments").c_str(),
+		lines[4].c_str());
+	EXPECT_STREQ("-first 5", lines[5].substr(lines[5].rfind('-')).c_str());
+	EXPECT_STREQ("-other 6", lines[6].substr(lines[6].rfind('-')).c_str());
+	EXPECT_STREQ("-buffer 7", lines[7].substr(lines[7].rfind('-')).c_str());
+	EXPECT_STREQ(("fatal:" + at(fatal_line) + "dying").c_str(),
+		lines[8].c_str());
+	text.clear();
+
+	std::stringstream truncated(out.str().substr(0, 10));
+	EXPECT_THROW(logs::decode_binlog(text, truncated), std::runtime_error);
+
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+}
+
+
+TEST(BINARY, DeferredLevels)
+{
+	std::stringstream out;
+	auto logger = std::make_shared<logs::BinaryLogger>(
+		std::make_shared<logs::StreamSink>(out), logs::batch_flush_size,
+		std::chrono::milliseconds(0));
+	logs::set_logger(logger);
+
+	// filtered records are dropped at the logger's level like log
+	EXPECT_EQ(nullptr, logger->begin_record(
+		logs::DEBUG, "debug %d", 1, false));
+	size_t deferred_line = __LINE__ + 4;
+	{
+		logs::LoggerGuard guard;
+		// deferf is called once the caller's level check passed
+		EXPECT_TRUE(logs::deferf(guard, logs::DEBUG, "debug %d", 2));
+		EXPECT_TRUE(logs::deferf(guard, logs::INFO, "info %d", 3));
+		// fatal messages are left to log
+		EXPECT_FALSE(logs::deferf(guard, logs::FATAL, "fatal %d", 4));
+	}
+	EXPECT_EQ(0, out.str().size());
+
+	size_t fatal_line = __LINE__ + 3;
+	try
+	{
+		LOGS_LOGF(FATAL, "dying %d", 5);
+		FAIL() << "binary logger failed to throw on fatal site";
+	}
+	catch (std::runtime_error& e)
+	{
+		EXPECT_STREQ("dying 5", e.what());
+	}
+	logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+
+	// fatal messages flush every record before throwing
+	std::stringstream text;
+	logs::decode_binlog(text, out);
+	// deferred records carry the location of their call
+	EXPECT_STREQ(fmts::sprintf("debug:%s:%zu-debug 2\n"
+		"info:%s:%zu-info 3\nfatal:%s:%zu-dying 5\n",
+		__FILE__, deferred_line, __FILE__, deferred_line + 1,
+		__FILE__, fatal_line).c_str(), text.str().c_str());
+}
+
+TEST(BINARY, Threads)
+{
+	const size_t nthreads = 4;
+	const size_t nlogs = 2000;
+	std::stringstream out;
+	{
+		// small flush size so threads write while others log
+		auto logger = std::make_shared<logs::BinaryLogger>(
+			std::make_shared<logs::StreamSink>(out), 256);
+		logs::set_logger(logger);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < nthreads; ++i)
+		{
+			threads.push_back(std::thread([i, nlogs]
+			{
+				for (size_t j = 0; j < nlogs; ++j)
+				{
+					logs::infof("thread %zu log %zu", i, j);
+				}
+			}));
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	}
+
+	std::stringstream text;
+	logs::decode_binlog(text, out);
+	std::vector<size_t> next(nthreads, 0);
+	std::string line;
+	size_t nlines = 0;
+	while (std::getline(text, line))
+	{
+		size_t i, j;
+		ASSERT_EQ(2, std::sscanf(line.substr(line.rfind('-') + 1).c_str(),
+			"thread %zu log %zu", &i, &j));
+		ASSERT_LT(i, nthreads);
+		EXPECT_EQ(next[i]++, j);
+		++nlines;
+	}
+	EXPECT_EQ(nthreads * nlogs, nlines);
+}
+
+
+TEST(SINK, Batches)
+{
+	struct CountSink final : public logs::iSink
+	{
+		void write (const char* data, size_t n) override
+		{
+			out_.append(data, n);
+			++nwrites_;
+		}
+
+		std::string out_;
+
+		size_t nwrites_ = 0;
+	};
+	auto sink = std::make_shared<CountSink>();
+	size_t debug_line;
+	{
+		logs::SinkLogger logger(sink, 64, std::chrono::milliseconds(0));
+		logger.log(logs::WARN, "first warning");
+		logger.log(logs::DEBUG, "disabled");
+		logger.log("error", "first error");
+		EXPECT_EQ(0, sink->nwrites_);
+
+		// passing the flush size writes the whole buffer in one batch
+		logger.log(logs::ERROR, "second error that passes the flush size");
+		EXPECT_EQ(1, sink->nwrites_);
+		EXPECT_STREQ(
+			"[WARNING]:first warning\n"
+			"[ERROR]:first error\n"
+			"[ERROR]:second error that passes the flush size\n",
+			sink->out_.c_str());
+
+		logger.set_log_level("debug");
+		logger.log(logs::DEBUG, "debugging");
+		debug_line = __LINE__ - 1;
+		EXPECT_EQ(1, sink->nwrites_);
+		EXPECT_THROW(logger.log(logs::FATAL, "dying"), std::runtime_error);
+		EXPECT_EQ(2, sink->nwrites_);
+		logger.log(logs::WARN, "last warning");
+	}
+	// unwritten lines are written on destruction
+	EXPECT_EQ(3, sink->nwrites_);
+	auto expect = fmts::sprintf(
+		"[WARNING]:first warning\n"
+		"[ERROR]:first error\n"
+		"[ERROR]:second error that passes the flush size\n"
+		"%s:%zu-debugging\n"
+		"[ERROR]:dying\n"
+		"[WARNING]:last warning\n", __FILE__, debug_line);
+	EXPECT_STREQ(expect.c_str(), sink->out_.c_str());
+}
+
+
+TEST(SINK, Rotate)
+{
+	std::string path = testing::TempDir() + "/logs_rotate.log";
+	std::remove(path.c_str());
+	std::remove((path + ".1").c_str());
+	std::remove((path + ".2").c_str());
+	{
+		auto sink = std::make_shared<logs::RotatingFileSink>(path, 10, 1);
+		sink->write("0123456", 7);
+		sink->write("789", 3);
+		sink->write("abcdef", 6);
+		sink->write("ghijk", 5);
+	}
+	auto read = [](const std::string& path)
+	{
+		std::ifstream file(path);
+		std::stringstream ss;
+		ss << file.rdbuf();
+		return ss.str();
+	};
+	EXPECT_STREQ("ghijk", read(path).c_str());
+	EXPECT_STREQ("abcdef", read(path + ".1").c_str());
+	EXPECT_FALSE(std::ifstream(path + ".2").good());
+
+	int fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+	ASSERT_LE(0, fd);
+	{
+		logs::FdSink sink(fd, true);
+		sink.write("lmn", 3);
+	}
+	EXPECT_STREQ("ghijklmn", read(path).c_str());
+	EXPECT_THROW(logs::RotatingFileSink(
+		testing::TempDir() + "/missing/dir.log", 10), std::runtime_error);
+	std::remove(path.c_str());
+	std::remove((path + ".1").c_str());
+}
+
+
+TEST(SINK, RotateBinary)
+{
+	std::string path = testing::TempDir() + "/logs_rotate.bin";
+	size_t message_line = 0;
+	std::remove(path.c_str());
+	std::remove((path + ".1").c_str());
+	{
+		logs::BinaryLogger logger(
+			std::make_shared<logs::RotatingFileSink>(path, 128),
+			1, std::chrono::milliseconds(0));
+		logs::set_logger(std::shared_ptr<logs::iLogger>(
+			&logger, [](logs::iLogger*){}));
+		for (int i = 0; i < 10; ++i)
+		{
+			logs::infof("message %d", i);
+		}
+		message_line = __LINE__ - 2;
+		logs::set_logger(std::static_pointer_cast<logs::iLogger>(tlogger));
+	}
+
+	// each file defines the formats it uses
+	std::ifstream rotated(path + ".1", std::ios::binary);
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream rotated_text;
+	std::stringstream text;
+	EXPECT_NO_THROW(logs::decode_binlog(rotated_text, rotated));
+	EXPECT_NO_THROW(logs::decode_binlog(text, file));
+	std::string all;
+	for (int i = 0; i < 10; ++i)
+	{
+		all += fmts::sprintf("info:%s:%zu-message %d\n",
+			__FILE__, message_line, i);
+	}
+	std::string kept = rotated_text.str() + text.str();
+	EXPECT_LT(0, rotated_text.str().size());
+	EXPECT_LT(0, text.str().size());
+	ASSERT_LE(kept.size(), all.size());
+	EXPECT_STREQ(all.substr(all.size() - kept.size()).c_str(), kept.c_str());
+	std::remove(path.c_str());
+	std::remove((path + ".1").c_str());
+}
+
+
 #endif // DISABLE_LOGS_TEST